@@ -0,0 +1,138 @@
+#include "BatchMode.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Job {
+  // Position in the input, counting only jobs.
+  std::uint64_t Seq;
+  std::uint64_t Line;
+  std::string Text;
+};
+
+void WriteJsonString(std::ostream &OS, const std::string &Str) {
+  static const char *Hex = "0123456789abcdef";
+  OS << '"';
+  for (unsigned char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C == '\n')
+      OS << "\\n";
+    else if (C < 0x20)
+      OS << "\\u00" << Hex[C >> 4] << Hex[C & 15];
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+std::string FormatResult(std::uint64_t Line, const BatchResult &Res,
+                         double Ms) {
+  std::ostringstream OS;
+  OS << "{\"id\":" << Line;
+  if (Res.Error.empty()) {
+    OS << ",\"p\":" << Res.P << ",\"m\":" << Res.M << ",\"irred\":";
+    WriteJsonString(OS, Res.IrredPoly);
+    OS << ",\"primitive\":";
+    WriteJsonString(OS, Res.Primitive);
+    OS << ",\"cached\":" << (Res.Cached ? "true" : "false");
+  } else {
+    OS << ",\"error\":";
+    WriteJsonString(OS, Res.Error);
+  }
+  OS << ",\"ms\":" << Ms << "}\n";
+  return OS.str();
+}
+} // namespace
+
+std::size_t RunBatch(std::istream &In, std::ostream &Out,
+                     const BatchOptions &Options, const BatchSolver &Solve) {
+  unsigned Workers = std::max(Options.Workers, 1u);
+  std::size_t Window = Options.Window ? Options.Window : 4 * Workers;
+
+  std::mutex Mutex;
+  std::condition_variable HasJob;
+  std::condition_variable HasRoom;
+  std::deque<Job> Queue;
+  bool InputDone = false;
+  // Read but not yet written.
+  std::size_t InFlight = 0;
+  std::size_t Failed = 0;
+  // Finished results waiting for the earlier ones in ordered mode.
+  std::map<std::uint64_t, std::string> Pending;
+  std::uint64_t NextToWrite = 0;
+
+  // Called with Mutex held.
+  auto Emit = [&](std::uint64_t Seq, std::string Text) {
+    if (!Options.Ordered) {
+      Out << Text;
+      InFlight--;
+    } else {
+      Pending.emplace(Seq, std::move(Text));
+      for (auto It = Pending.begin();
+           It != Pending.end() && It->first == NextToWrite;
+           It = Pending.erase(It), NextToWrite++, InFlight--)
+        Out << It->second;
+    }
+    Out.flush();
+    HasRoom.notify_one();
+  };
+
+  auto Worker = [&]() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (true) {
+      HasJob.wait(Lock, [&]() { return !Queue.empty() || InputDone; });
+      if (Queue.empty())
+        return;
+      auto J = std::move(Queue.front());
+      Queue.pop_front();
+      Lock.unlock();
+
+      auto T1 = std::chrono::steady_clock::now();
+      auto Res = Solve(J.Text);
+      std::chrono::duration<double, std::milli> Ms =
+          std::chrono::steady_clock::now() - T1;
+      auto Text = FormatResult(J.Line, Res, Ms.count());
+
+      Lock.lock();
+      if (!Res.Error.empty())
+        Failed++;
+      Emit(J.Seq, std::move(Text));
+    }
+  };
+
+  std::vector<std::thread> Threads;
+  Threads.reserve(Workers);
+  for (unsigned I = 0; I < Workers; I++)
+    Threads.emplace_back(Worker);
+
+  std::string Text;
+  std::uint64_t Line = 0;
+  std::uint64_t Seq = 0;
+  while (std::getline(In, Text)) {
+    Line++;
+    auto First = Text.find_first_not_of(" \t\r");
+    if (First == std::string::npos || Text[First] == '#')
+      continue;
+    std::unique_lock<std::mutex> Lock(Mutex);
+    HasRoom.wait(Lock, [&]() { return InFlight < Window; });
+    Queue.push_back({Seq++, Line, std::move(Text)});
+    InFlight++;
+    HasJob.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    InputDone = true;
+  }
+  HasJob.notify_all();
+  for (auto &T : Threads)
+    T.join();
+  return Failed;
+}
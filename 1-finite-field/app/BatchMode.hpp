@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+
+// Batch mode of the app: jobs are read one per line, solved on a fixed pool
+// of worker threads and reported as one JSON object per line. At most Window
+// jobs are between being read and being written at any time, so a slow job
+// stalls the reader instead of growing the queues.
+
+// What a solver reports for one job. Empty Error means success.
+struct BatchResult {
+  std::string Error;
+  std::uint64_t P = 0;
+  std::uint64_t M = 0;
+  std::string IrredPoly;
+  std::string Primitive;
+  bool Cached = false;
+};
+
+// Solves the job on one input line. Called concurrently from the workers.
+using BatchSolver = std::function<BatchResult(const std::string &Line)>;
+
+struct BatchOptions {
+  unsigned Workers = 1;
+  // Write results in input order; otherwise as they finish.
+  bool Ordered = true;
+  // Jobs in flight; 0 picks 4 per worker.
+  std::size_t Window = 0;
+};
+
+// Runs every non-empty line of In that does not start with '#' and writes
+// {"id": <line number>, ...result..., "ms": <job time>} lines to Out. Returns
+// the number of failed jobs.
+std::size_t RunBatch(std::istream &In, std::ostream &Out,
+                     const BatchOptions &Options, const BatchSolver &Solve);
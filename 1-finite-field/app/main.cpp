@@ -1,9 +1,20 @@
+#include "BatchMode.hpp"
+#include <BinaryField.hpp>
+#include <FieldCache.hpp>
 #include <FiniteField.hpp>
 #include <Polynom.hpp>
+#include <Stats.hpp>
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <istream>
+#include <optional>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 template <typename T,
           std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
@@ -29,6 +40,201 @@ bool ReadPoly(const std::string &Input, std::vector<std::uint64_t> &Coeffs) {
   return true;
 }
 
+// Sets f(x) of F unless PolyCoeffs is empty, in which case the field picks
+// it itself. Returns false if the given f(x) is not of degree M.
+template <class FieldT>
+bool SetIrredPoly(FieldT &F, std::size_t M,
+                  const std::vector<std::uint64_t> &PolyCoeffs) {
+  if (PolyCoeffs.empty())
+    return true;
+  auto *PF = F.getPrimeField();
+  std::vector<typename FieldT::ElementType::CoeffT> IrredCoeffs;
+  IrredCoeffs.reserve(PolyCoeffs.size());
+  for (auto C : PolyCoeffs)
+    IrredCoeffs.emplace_back(C, PF);
+  typename FieldT::ElementType Poly(PF, IrredCoeffs);
+  if (Poly.getDegree() != M)
+    return false;
+  F.setIrredPoly(Poly);
+  return true;
+}
+
+// MMATH_FIELD_CACHE names a directory where the primitive element and the
+// factorization of p^m - 1 are kept between runs. Traced and exhaustive
+// searches always run.
+std::optional<mmath::field::FieldCache> GetFieldCache(bool Verbose,
+                                                      bool AllDegs) {
+  if (const char *Dir = std::getenv("MMATH_FIELD_CACHE"))
+    if (*Dir && !Verbose && !AllDegs)
+      return mmath::field::FieldCache(Dir);
+  return std::nullopt;
+}
+
+// Takes the primitive element from the cache if it has one, otherwise
+// searches for it and stores the result.
+template <class FieldT>
+typename FieldT::ElementType
+LoadOrFindPrimitive(FieldT &F,
+                    const std::optional<mmath::field::FieldCache> &Cache,
+                    bool Verbose, bool AllDegs, unsigned Threads,
+                    bool &Cached) {
+  Cached = Cache && F.loadFrom(*Cache);
+  if (Cached)
+    return F.getCachedPrimitiveElement();
+  auto Pr = F.getPrimitiveElement(Verbose, Verbose, AllDegs, Threads);
+  if (Cache && !F.saveTo(*Cache))
+    std::cerr << "Could not write the field cache to " << Cache->getDir()
+              << "\n";
+  return Pr;
+}
+
+// Empty PolyCoeffs means the field picks f(x) itself. Returns false if the
+// given f(x) is reducible.
+template <class FieldT>
+bool FindPrimitive(std::size_t P, std::size_t M,
+                   const std::vector<std::uint64_t> &PolyCoeffs, bool Verbose,
+                   bool AllDegs, unsigned Threads) {
+  using std::chrono::duration;
+  using std::chrono::high_resolution_clock;
+
+  FieldT F(P, M);
+  if (!SetIrredPoly(F, M, PolyCoeffs)) {
+    std::cerr << "Polynom must have degree " << M << "\n";
+    return false;
+  }
+  const auto &IrredPoly = F.getIrredPoly();
+  // std::cout << "Irreducible polynom is ";
+  if (Verbose)
+    IrredPoly.print(std::cout);
+  else
+    IrredPoly.printVector(std::cout, M + 1);
+  if (!F.isIrreducible()) {
+    std::cerr << "Polynom is reducible\n";
+    return false;
+  }
+
+  auto Cache = GetFieldCache(Verbose, AllDegs);
+  auto t1 = high_resolution_clock::now();
+  bool Cached;
+  auto Pr = LoadOrFindPrimitive(F, Cache, Verbose, AllDegs, Threads, Cached);
+  auto t2 = high_resolution_clock::now();
+  std::cout << "Primitive element is ";
+  if (Verbose)
+    Pr.print(std::cout);
+  else
+    Pr.printVector(std::cout, M);
+  duration<double, std::milli> ms_double = t2 - t1;
+  std::cout << "Time Elapsed: " << ms_double.count() << "ms\n";
+  return true;
+}
+
+// Coefficients as printed by printVector, without the newline.
+template <class PolyT>
+std::string CoeffString(const PolyT &Poly, std::size_t Size) {
+  std::ostringstream OS;
+  Poly.printVector(OS, Size);
+  auto Str = OS.str();
+  Str.pop_back();
+  return Str;
+}
+
+// Batch counterpart of FindPrimitive: one single-threaded search, reported
+// instead of printed.
+template <class FieldT>
+BatchResult SolveJob(std::size_t P, std::size_t M,
+                     const std::vector<std::uint64_t> &PolyCoeffs) {
+  BatchResult Res;
+  Res.P = P;
+  Res.M = M;
+  FieldT F(P, M);
+  if (!SetIrredPoly(F, M, PolyCoeffs)) {
+    Res.Error = "Polynom must have degree " + std::to_string(M);
+    return Res;
+  }
+  Res.IrredPoly = CoeffString(F.getIrredPoly(), M + 1);
+  if (!F.isIrreducible()) {
+    Res.Error = "Polynom is reducible";
+    return Res;
+  }
+  auto Pr = LoadOrFindPrimitive(F, GetFieldCache(false, false), false, false,
+                                1, Res.Cached);
+  Res.Primitive = CoeffString(Pr, M);
+  return Res;
+}
+
+template <class T> struct FieldTag {
+  using Type = T;
+};
+
+// Calls Fn(FieldTag<FieldT>()) with the field type used for characteristic
+// P. Characteristic 2 uses the bit-packed field, other orders we deploy with
+// get a compile-time prime field.
+template <class FnT> auto DispatchField(std::size_t P, FnT Fn) {
+  using namespace mmath::field;
+  switch (P) {
+  case 2:
+    return Fn(FieldTag<BinaryFiniteField>());
+  case 3:
+    return Fn(FieldTag<BasicFiniteField<StaticPrimeField<3>>>());
+  case 251:
+    return Fn(FieldTag<BasicFiniteField<StaticPrimeField<251>>>());
+  case 65537:
+    return Fn(FieldTag<BasicFiniteField<StaticPrimeField<65537>>>());
+  default:
+    return Fn(FieldTag<FiniteField>());
+  }
+}
+
+// Whether p^m fits in 64 bits, which all fields require.
+bool OrderFits(std::uint64_t P, std::uint64_t M) {
+  std::uint64_t Order = 1;
+  for (std::uint64_t I = 0; I < M; I++) {
+    if (Order > UINT64_MAX / P)
+      return false;
+    Order *= P;
+  }
+  return true;
+}
+
+// Checks P and M against what every field supports. ModReducer needs
+// P < 2^63. Returns the error message, or an empty string if they are usable.
+std::string CheckFieldParams(std::uint64_t P, std::uint64_t M) {
+  if (P < 2 || !mmath::field::IsPrime(P))
+    return "P must be prime";
+  if (P >= (std::uint64_t(1) << 63))
+    return "P must be below 2^63";
+  if (M == 0)
+    return "M must be positive";
+  if (!OrderFits(P, M))
+    return "P^M must fit in 64 bits";
+  return "";
+}
+
+// A job line is "P M [polynom|auto]".
+BatchResult SolveJobLine(const std::string &Line) {
+  std::istringstream IS(Line);
+  std::string PStr, MStr, PolyStr = "auto", Extra;
+  IS >> PStr >> MStr >> PolyStr;
+  BatchResult Res;
+  std::size_t P, M;
+  std::vector<std::uint64_t> PolyCoeffs;
+  if (IS >> Extra)
+    Res.Error = "Expected 'P M [polynom|auto]'";
+  else if (!ParseInt(PStr, P))
+    Res.Error = "Error reading P from " + PStr;
+  else if (!ParseInt(MStr, M))
+    Res.Error = "Error reading M from " + MStr;
+  else if (auto Error = CheckFieldParams(P, M); !Error.empty())
+    Res.Error = std::move(Error);
+  else if (PolyStr != "auto" && !ReadPoly(PolyStr, PolyCoeffs))
+    Res.Error = "Error reading polynom from " + PolyStr;
+  if (!Res.Error.empty())
+    return Res;
+  return DispatchField(P, [&](auto Tag) {
+    return SolveJob<typename decltype(Tag)::Type>(P, M, PolyCoeffs);
+  });
+}
+
 int main(int argc, char const *argv[]) {
   using namespace mmath::field;
   using std::chrono::duration;
@@ -44,6 +250,61 @@ int main(int argc, char const *argv[]) {
   std::vector<std::uint64_t> PolyCoeffs;
   bool Verbose = false;
   bool AllDegs = false;
+  unsigned Threads = 1;
+  bool Stats = false;
+  std::optional<std::string> BatchInput;
+  BatchOptions Batch;
+  Batch.Workers = 0;
+
+  // Options may appear anywhere; everything else is positional.
+  //   --stats          print operation counters at exit
+  //   --batch[=FILE]   read "P M [polynom|auto]" jobs from FILE or stdin
+  //   --jobs=N         batch workers, 0 (default) for one per core
+  //   --unordered      write batch results as they finish
+  std::vector<const char *> Args = {argv[0]};
+  for (int I = 1; I < argc; I++) {
+    std::string Arg = argv[I];
+    if (Arg == "--stats") {
+      Stats = true;
+    } else if (Arg == "--batch" || Arg == "--batch=-") {
+      BatchInput = "";
+    } else if (Arg.rfind("--batch=", 0) == 0) {
+      BatchInput = Arg.substr(8);
+    } else if (Arg.rfind("--jobs=", 0) == 0) {
+      if (!ParseInt(Arg.substr(7), Batch.Workers)) {
+        std::cerr << "Error reading job count from " << Arg << "\n";
+        return 1;
+      }
+    } else if (Arg == "--unordered") {
+      Batch.Ordered = false;
+    } else {
+      Args.push_back(argv[I]);
+    }
+  }
+  argc = static_cast<int>(Args.size());
+  argv = Args.data();
+
+  if (BatchInput) {
+    if (argc > 1) {
+      std::cerr << "Batch mode takes no positional arguments\n";
+      return 1;
+    }
+    if (Batch.Workers == 0)
+      Batch.Workers = std::max(1u, std::thread::hardware_concurrency());
+    std::ifstream File;
+    if (!BatchInput->empty()) {
+      File.open(*BatchInput);
+      if (!File) {
+        std::cerr << "Could not open " << *BatchInput << "\n";
+        return 1;
+      }
+    }
+    std::istream &In = BatchInput->empty() ? std::cin : File;
+    auto Failed = RunBatch(In, std::cout, Batch, SolveJobLine);
+    if (Stats)
+      stats::printReport(std::cerr);
+    return Failed ? 1 : 0;
+  }
 
   if (argc > 1) {
     if (!ParseInt(argv[1], P)) {
@@ -62,7 +323,7 @@ int main(int argc, char const *argv[]) {
   }
 
   if (argc > 3) {
-    if (!ReadPoly(argv[3], PolyCoeffs)) {
+    if (std::string(argv[3]) != "auto" && !ReadPoly(argv[3], PolyCoeffs)) {
       std::cerr << "Error reading polynom from " << argv[3] << "\n";
       return 1;
     }
@@ -84,6 +345,15 @@ int main(int argc, char const *argv[]) {
     }
   }
 
+  if (argc > 6) {
+    if (!ParseInt(argv[6], Threads)) {
+      std::cerr << "Error reading thread count from " << argv[6] << "\n";
+      return 1;
+    }
+    if (Threads == 0)
+      Threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
   while (!HasP) {
     std::cout << "Enter P: ";
     std::string In;
@@ -105,10 +375,10 @@ int main(int argc, char const *argv[]) {
   }
 
   while (!HasPoly) {
-    std::cout << "Enter polynom (e.g. 101 for 1+x^2): ";
+    std::cout << "Enter polynom (e.g. 101 for 1+x^2, or auto): ";
     std::string In;
     std::getline(std::cin, In);
-    if (!ReadPoly(In, PolyCoeffs))
+    if (In != "auto" && !ReadPoly(In, PolyCoeffs))
       std::cerr << "Error reading polynom from " << In << "\n";
     else
       HasPoly = true;
@@ -124,30 +394,20 @@ int main(int argc, char const *argv[]) {
       HasVerbose = true;
   }
 
-  FiniteField F(P, M);
-  auto *PF = F.getPrimeField();
-  std::vector<FiniteField::ElementType::CoeffT> IrredCoeffs;
-  IrredCoeffs.reserve(PolyCoeffs.size());
-  for (auto C : PolyCoeffs)
-    IrredCoeffs.emplace_back(C, PF);
-  FiniteField::ElementType IrredPoly(PF, IrredCoeffs);
-  // std::cout << "Irreducible polynom is ";
-  if (Verbose)
-    IrredPoly.print(std::cout);
-  else
-    IrredPoly.printVector(std::cout, M + 1);
-  F.setIrredPoly(IrredPoly);
+  auto Error = CheckFieldParams(P, M);
+  if (!Error.empty()) {
+    std::cerr << Error << "\n";
+    return 1;
+  }
 
-  auto t1 = high_resolution_clock::now();
-  auto Pr = F.getPrimitiveElement(Verbose, Verbose, AllDegs);
-  auto t2 = high_resolution_clock::now();
-  std::cout << "Primitive element is ";
-  if (Verbose)
-    Pr.print(std::cout);
-  else
-    Pr.printVector(std::cout, M);
-  duration<double, std::milli> ms_double = t2 - t1;
-  std::cout << "Time Elapsed: " << ms_double.count() << "ms\n";
+  bool Ok = DispatchField(P, [&](auto Tag) {
+    return FindPrimitive<typename decltype(Tag)::Type>(P, M, PolyCoeffs,
+                                                       Verbose, AllDegs,
+                                                       Threads);
+  });
+
+  if (Stats)
+    stats::printReport(std::cout);
 
   // +, *, / examples:
   // FieldT Field(3);
@@ -173,5 +433,5 @@ int main(int argc, char const *argv[]) {
   // R.trim();
   // R.print(std::cout);
   // std::cout << "Rem is zero = " << R.isZero() << "\n";
-  return 0;
+  return Ok ? 0 : 1;
 }
@@ -0,0 +1,527 @@
+#include <BinaryField.hpp>
+#include <ErasureCode.hpp>
+#include <FiniteField.hpp>
+#include <FixedFiniteField.hpp>
+#include <Matrix.hpp>
+#include <Polynom.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Microbenchmarks for field and polynom operations. Prints a table by
+// default, or JSON with --json so that results can be compared between
+// releases.
+//
+// Usage: 1_finite_field_bench [--json] [--filter SUBSTR] [--reps N]
+//                             [--min-time-ms MS]
+
+namespace {
+using namespace mmath::field;
+using Clock = std::chrono::steady_clock;
+
+// Keeps the compiler from optimizing away a computed value.
+template <class T> void DoNotOptimize(const T &Value) {
+  asm volatile("" : : "r,m"(Value) : "memory");
+}
+
+struct Options {
+  bool Json = false;
+  std::string Filter;
+  std::size_t Repetitions = 10;
+  std::size_t WarmupBatches = 2;
+  double MinBatchMs = 20;
+};
+
+struct Result {
+  std::string Name;
+  std::uint64_t P;
+  std::uint64_t M;
+  std::size_t Iterations;
+  // Nanoseconds per operation, one entry per repetition.
+  std::vector<double> Samples;
+
+  double min() const {
+    return *std::min_element(Samples.begin(), Samples.end());
+  }
+
+  double max() const {
+    return *std::max_element(Samples.begin(), Samples.end());
+  }
+
+  double mean() const {
+    double Sum = 0;
+    for (auto S : Samples)
+      Sum += S;
+    return Sum / Samples.size();
+  }
+
+  double median() const {
+    auto Sorted = Samples;
+    std::sort(Sorted.begin(), Sorted.end());
+    auto Mid = Sorted.size() / 2;
+    return Sorted.size() % 2 ? Sorted[Mid]
+                             : (Sorted[Mid - 1] + Sorted[Mid]) / 2;
+  }
+
+  double stddev() const {
+    if (Samples.size() < 2)
+      return 0;
+    double Mean = mean(), Sum = 0;
+    for (auto S : Samples)
+      Sum += (S - Mean) * (S - Mean);
+    return std::sqrt(Sum / (Samples.size() - 1));
+  }
+};
+
+class Runner {
+private:
+  Options Opts;
+  std::vector<Result> Results;
+
+  template <class FnT> double TimeBatch(FnT &Fn, std::size_t Iterations) {
+    auto Start = Clock::now();
+    for (std::size_t I = 0; I < Iterations; I++)
+      Fn();
+    std::chrono::duration<double, std::nano> Elapsed = Clock::now() - Start;
+    return Elapsed.count();
+  }
+
+public:
+  explicit Runner(Options Opts) : Opts(std::move(Opts)) {}
+
+  // Runs Fn in batches long enough to time reliably: first to pick the batch
+  // size, then WarmupBatches untimed batches, then Repetitions timed ones.
+  template <class FnT>
+  void run(const std::string &Name, std::uint64_t P, std::uint64_t M, FnT Fn) {
+    if (!Opts.Filter.empty() && Name.find(Opts.Filter) == std::string::npos)
+      return;
+    std::size_t Iterations = 1;
+    while (TimeBatch(Fn, Iterations) < Opts.MinBatchMs * 1e6 &&
+           Iterations < (std::size_t(1) << 30))
+      Iterations *= 2;
+    for (std::size_t I = 0; I < Opts.WarmupBatches; I++)
+      TimeBatch(Fn, Iterations);
+    Result Res{Name, P, M, Iterations, {}};
+    for (std::size_t I = 0; I < Opts.Repetitions; I++)
+      Res.Samples.push_back(TimeBatch(Fn, Iterations) / Iterations);
+    if (!Opts.Json)
+      std::cout << std::left << std::setw(32) << Name << std::right
+                << std::setw(12) << P << std::setw(4) << M << std::setw(14)
+                << std::fixed << std::setprecision(1) << Res.median()
+                << " ns  +-" << std::setw(6) << Res.stddev() << "\n";
+    Results.push_back(std::move(Res));
+  }
+
+  void printJson(std::ostream &OS) const {
+    auto Now = std::chrono::system_clock::to_time_t(
+        std::chrono::system_clock::now());
+    OS << "{\n  \"context\": {\n";
+    OS << "    \"timestamp\": " << Now << ",\n";
+    OS << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+    OS << "    \"hardware_clmul\": "
+       << (HasHardwareCarrylessMul() ? "true" : "false") << ",\n";
+    OS << "    \"bulk_kernel\": \"" << BulkKernelName() << "\",\n";
+#ifdef NDEBUG
+    OS << "    \"assertions\": false,\n";
+#else
+    OS << "    \"assertions\": true,\n";
+#endif
+    OS << "    \"repetitions\": " << Opts.Repetitions << "\n  },\n";
+    OS << "  \"benchmarks\": [";
+    for (std::size_t I = 0; I < Results.size(); I++) {
+      const auto &R = Results[I];
+      OS << (I ? ",\n" : "\n") << std::setprecision(3) << std::fixed;
+      OS << "    {\"name\": \"" << R.Name << "\", \"p\": " << R.P
+         << ", \"m\": " << R.M << ", \"iterations\": " << R.Iterations
+         << ", \"unit\": \"ns\", \"mean\": " << R.mean()
+         << ", \"median\": " << R.median() << ", \"min\": " << R.min()
+         << ", \"max\": " << R.max() << ", \"stddev\": " << R.stddev() << "}";
+    }
+    OS << "\n  ]\n}\n";
+  }
+};
+
+struct FieldParams {
+  std::uint64_t P;
+  std::uint64_t M;
+  // Irreducible polynom, lowest degree first.
+  std::vector<std::uint64_t> IrredCoeffs;
+  // Whether to time getPrimitiveElement. The search is not cached and scans
+  // all p constants before any degree-1 candidate, so it is left off where p
+  // is too large for a single search to finish.
+  bool PrimitiveSearch = true;
+};
+
+template <class PrimeFieldT>
+void BenchPrimeField(Runner &R, std::uint64_t P) {
+  PrimeFieldT F(P);
+  std::mt19937_64 Rng(P);
+  std::vector<typename PrimeFieldT::ElementType> Values;
+  for (std::size_t I = 0; I < 1024; I++)
+    Values.push_back(F.getValue(Rng() % (P - 1) + 1));
+  std::size_t Idx = 0;
+  auto Next = [&]() -> const typename PrimeFieldT::ElementType & {
+    Idx = (Idx + 1) % Values.size();
+    return Values[Idx];
+  };
+
+  auto Acc = F.one();
+  R.run("prime_field/add", P, 1, [&] {
+    Acc += Next();
+    DoNotOptimize(Acc);
+  });
+  R.run("prime_field/mul", P, 1, [&] {
+    Acc *= Next();
+    DoNotOptimize(Acc);
+  });
+  R.run("prime_field/inverse", P, 1, [&] {
+    auto Inv = Next().inverseMul();
+    DoNotOptimize(Inv);
+  });
+}
+
+// Bulk operations over spans of raw residues, timed per whole span.
+void BenchBulk(Runner &R, std::uint64_t P) {
+  constexpr std::size_t Count = 4096;
+  PrimeField F(P);
+  std::mt19937_64 Rng(P);
+  std::vector<std::uint64_t> A(Count), B(Count), Out(Count);
+  for (std::size_t I = 0; I < Count; I++) {
+    A[I] = Rng() % P;
+    B[I] = Rng() % P;
+  }
+  auto Scalar = Rng() % P;
+  R.run("prime_field/bulk_mul_4096", P, 1, [&] {
+    F.mul(Out.data(), A.data(), B.data(), Count);
+    DoNotOptimize(Out.data());
+  });
+  R.run("prime_field/bulk_axpy_4096", P, 1, [&] {
+    F.axpy(Out.data(), Scalar, A.data(), Count);
+    DoNotOptimize(Out.data());
+  });
+  R.run("prime_field/bulk_dot_4096", P, 1, [&] {
+    auto Dot = F.dot(A.data(), B.data(), Count);
+    DoNotOptimize(Dot);
+  });
+  R.run("prime_field/bulk_inverse_4096", P, 1, [&] {
+    F.inverse(Out.data(), A.data(), Count);
+    DoNotOptimize(Out.data());
+  });
+}
+
+void BenchMatrix(Runner &R, std::uint64_t P, std::size_t N) {
+  PrimeField F(P);
+  std::mt19937_64 Rng(P + N);
+  Matrix<PrimeField> M(&F, N, N);
+  for (std::size_t I = 0; I < N; I++)
+    for (std::size_t J = 0; J < N; J++)
+      M.at(I, J) = Rng() % P;
+  R.run("matrix/rref_" + std::to_string(N), P, 1, [&] {
+    auto Copy = M;
+    auto Pivots = Copy.reducedRowEchelonInPlace();
+    DoNotOptimize(Pivots);
+  });
+}
+
+template <class FieldT>
+typename FieldT::ElementType MakePoly(const FieldT &F,
+                                      const std::vector<std::uint64_t> &Vals) {
+  auto *PF = F.getPrimeField();
+  std::vector<typename FieldT::ElementType::CoeffT> Coeffs;
+  for (auto V : Vals)
+    Coeffs.emplace_back(V, PF);
+  return typename FieldT::ElementType(PF, Coeffs);
+}
+
+template <class FieldT>
+void BenchField(Runner &R, const std::string &Prefix, const FieldParams &FP) {
+  FieldT F(FP.P, FP.M);
+  auto IrredPoly = MakePoly(F, FP.IrredCoeffs);
+  F.setIrredPoly(IrredPoly);
+
+  std::mt19937_64 Rng(FP.P * 31 + FP.M);
+  auto RandomElement = [&] {
+    std::vector<std::uint64_t> Vals(FP.M);
+    for (auto &V : Vals)
+      V = Rng() % FP.P;
+    Vals.back() = Vals.back() ? Vals.back() : 1;
+    return MakePoly(F, Vals);
+  };
+  auto A = RandomElement();
+  auto B = RandomElement();
+  auto Prod = A.mul(B);
+
+  R.run(Prefix + "poly/sum", FP.P, FP.M, [&] {
+    auto S = A.sum(B);
+    DoNotOptimize(S);
+  });
+  R.run(Prefix + "poly/mul", FP.P, FP.M, [&] {
+    auto S = A.mul(B);
+    DoNotOptimize(S);
+  });
+  R.run(Prefix + "poly/div", FP.P, FP.M, [&] {
+    typename FieldT::ElementType Rem(F.getPrimeField());
+    auto Q = Prod.div(IrredPoly, Rem);
+    DoNotOptimize(Q);
+    DoNotOptimize(Rem);
+  });
+  R.run(Prefix + "poly/pow8", FP.P, FP.M, [&] {
+    auto S = A.pow(8);
+    DoNotOptimize(S);
+  });
+  R.run(Prefix + "field/pow_mod", FP.P, FP.M, [&] {
+    auto S = F.powMod(A, F.getOrder() - 2);
+    DoNotOptimize(S);
+  });
+  R.run(Prefix + "field/inverse", FP.P, FP.M, [&] {
+    auto S = F.inverse(A);
+    DoNotOptimize(S);
+  });
+  if (!FP.PrimitiveSearch)
+    return;
+  R.run(Prefix + "field/primitive_search", FP.P, FP.M, [&] {
+    auto &Pr = F.getPrimitiveElement();
+    DoNotOptimize(Pr);
+  });
+}
+
+// Inverts 256 random elements at once.
+void BenchBatchInverse(Runner &R, const FieldParams &FP) {
+  FiniteField F(FP.P, FP.M);
+  F.setIrredPoly(MakePoly(F, FP.IrredCoeffs));
+  std::mt19937_64 Rng(FP.P * 17 + FP.M);
+  std::vector<FiniteField::ElementType> Elements, Out;
+  for (std::size_t I = 0; I < 256; I++) {
+    std::vector<std::uint64_t> Vals(FP.M);
+    for (auto &V : Vals)
+      V = Rng() % FP.P;
+    Elements.push_back(MakePoly(F, Vals));
+  }
+  Out = Elements;
+  R.run("field/batch_inverse_256", FP.P, FP.M, [&] {
+    F.inverse(Out.data(), Elements.data(), Elements.size());
+    DoNotOptimize(Out.data());
+  });
+}
+
+template <class FieldT> void BenchGenerator(Runner &R, const FieldParams &FP) {
+  FieldT F(FP.P, FP.M);
+  std::optional<typename FieldT::ElementGenerator> Gen;
+  Gen.emplace(&F);
+  R.run("field/generator_next", FP.P, FP.M, [&] {
+    if (Gen->HitZero)
+      Gen.emplace(&F);
+    auto E = Gen->next();
+    DoNotOptimize(E);
+  });
+}
+
+// Multiplication and gcd of long polynoms, where Karatsuba, NTT and half-GCD
+// take over.
+void BenchLongMul(Runner &R, std::uint64_t P, std::size_t Size) {
+  PrimeField F(P);
+  std::mt19937_64 Rng(P + Size);
+  auto RandomPoly = [&] {
+    std::vector<PrimeField::ElementType> Coeffs;
+    for (std::size_t I = 0; I < Size; I++)
+      Coeffs.push_back(F.getValue(Rng() % (P - 1) + 1));
+    return mmath::Polynom<PrimeField>(&F, std::move(Coeffs));
+  };
+  auto A = RandomPoly();
+  auto B = RandomPoly();
+  R.run("poly/mul_" + std::to_string(Size), P, 1, [&] {
+    auto S = A.mul(B);
+    DoNotOptimize(S);
+  });
+  R.run("poly/xgcd_" + std::to_string(Size), P, 1, [&] {
+    mmath::Polynom<PrimeField> S(&F), T(&F);
+    auto G = A.xgcd(B, S, T);
+    DoNotOptimize(G);
+  });
+}
+
+// Subproduct tree evaluation at Size points and interpolation back.
+void BenchMultipoint(Runner &R, std::uint64_t P, std::size_t Size) {
+  PrimeField F(P);
+  std::mt19937_64 Rng(P + Size);
+  std::vector<PrimeField::ElementType> Points, Coeffs;
+  for (std::size_t I = 0; I < Size; I++) {
+    Points.push_back(F.getValue(I + 1));
+    Coeffs.push_back(F.getValue(Rng() % P));
+  }
+  mmath::Polynom<PrimeField> A(&F, Coeffs);
+  mmath::field::SubproductTree Tree(P, Points);
+  auto Values = A.evaluate(Tree);
+  auto Suffix = std::to_string(Size);
+  R.run("poly/subproduct_tree_" + Suffix, P, 1, [&] {
+    mmath::field::SubproductTree T(P, Points);
+    DoNotOptimize(T);
+  });
+  R.run("poly/multipoint_eval_" + Suffix, P, 1, [&] {
+    auto V = A.evaluate(Tree);
+    DoNotOptimize(V);
+  });
+  R.run("poly/interpolate_" + Suffix, P, 1, [&] {
+    auto B = mmath::Polynom<PrimeField>::interpolate(&F, Tree, Values);
+    DoNotOptimize(B);
+  });
+}
+
+// FixedFiniteField against BasicFiniteField over the same StaticPrimeField
+// and f(x), including a pass over a flat array of 4096 elements.
+template <std::uint64_t P, std::size_t M> void BenchFixedField(Runner &R) {
+  using BasicT = BasicFiniteField<StaticPrimeField<P>>;
+  using FixedT = FixedFiniteField<P, M>;
+  BasicT Basic(P, M);
+  FixedT Fixed(Basic);
+  std::mt19937_64 Rng(P * 7 + M);
+  std::vector<typename FixedT::ElementType> Elements(4096);
+  for (auto &E : Elements)
+    E = FixedT::getElementAt(Rng() % (FixedT::Order - 1) + 1);
+  auto A = Elements[0], B = Elements[1];
+  auto BasicA = Fixed.toPolynom(A, Basic.getPrimeField());
+  auto BasicB = Fixed.toPolynom(B, Basic.getPrimeField());
+
+  R.run("static/mul_mod", P, M, [&] {
+    auto S = Basic.reduce(BasicA.mul(BasicB));
+    DoNotOptimize(S);
+  });
+  R.run("static/pow_mod", P, M, [&] {
+    auto S = Basic.powMod(BasicA, FixedT::Order - 2);
+    DoNotOptimize(S);
+  });
+  R.run("fixed/mul_mod", P, M, [&] {
+    auto S = Fixed.mulMod(A, B);
+    DoNotOptimize(S);
+  });
+  R.run("fixed/pow_mod", P, M, [&] {
+    auto S = Fixed.powMod(A, FixedT::Order - 2);
+    DoNotOptimize(S);
+  });
+  R.run("fixed/mul_array_4096", P, M, [&] {
+    auto Acc = FixedT::one();
+    for (const auto &E : Elements)
+      Acc = Fixed.mulMod(Acc, E);
+    DoNotOptimize(Acc);
+  });
+  auto Out = Elements;
+  R.run("fixed/batch_inverse_4096", P, M, [&] {
+    Fixed.inverse(Out.data(), Elements.data(), Elements.size());
+    DoNotOptimize(Out.data());
+  });
+}
+
+// Reed-Solomon over 1 MiB shards: encoding, and rebuilding the maximum
+// number of lost data shards.
+void BenchErasure(Runner &R, const Gf256 &F, std::size_t K, std::size_t N) {
+  constexpr std::size_t Len = 1 << 20;
+  ReedSolomon RS(F, K, N);
+  std::mt19937_64 Rng(K * N);
+  std::vector<std::vector<std::uint8_t>> Shards(
+      N, std::vector<std::uint8_t>(Len));
+  std::vector<std::uint8_t *> Ptrs;
+  for (auto &S : Shards)
+    Ptrs.push_back(S.data());
+  for (std::size_t I = 0; I < K; I++)
+    for (auto &B : Shards[I])
+      B = static_cast<std::uint8_t>(Rng());
+  auto Name = std::to_string(K) + "_" + std::to_string(N - K) + "_1MiB";
+  R.run("erasure/encode_" + Name, 256, 1, [&] {
+    RS.encode(Ptrs.data(), Ptrs.data() + K, Len);
+    DoNotOptimize(Ptrs[K]);
+  });
+  std::unique_ptr<bool[]> Present(new bool[N]);
+  for (std::size_t I = 0; I < N; I++)
+    Present[I] = I >= N - K;
+  R.run("erasure/reconstruct_" + Name, 256, 1, [&] {
+    RS.reconstruct(Ptrs.data(), Present.get(), Len);
+    DoNotOptimize(Ptrs[0]);
+  });
+}
+
+bool ParseArgs(int argc, char const *argv[], Options &Opts) {
+  for (int I = 1; I < argc; I++) {
+    std::string Arg = argv[I];
+    bool HasValue = I + 1 < argc;
+    if (Arg == "--json")
+      Opts.Json = true;
+    else if (Arg == "--filter" && HasValue)
+      Opts.Filter = argv[++I];
+    else if (Arg == "--reps" && HasValue)
+      Opts.Repetitions = std::max(1, std::atoi(argv[++I]));
+    else if (Arg == "--min-time-ms" && HasValue)
+      Opts.MinBatchMs = std::atof(argv[++I]);
+    else {
+      std::cerr << "Unknown argument " << Arg << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+int main(int argc, char const *argv[]) {
+  Options Opts;
+  if (!ParseArgs(argc, argv, Opts)) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--json] [--filter SUBSTR] [--reps N] [--min-time-ms MS]\n";
+    return 1;
+  }
+  Runner R(Opts);
+
+  BenchPrimeField<PrimeField>(R, 3);
+  BenchPrimeField<PrimeField>(R, 65537);
+  BenchPrimeField<PrimeField>(R, 998244353);
+  BenchBulk(R, 65537);
+  BenchBulk(R, 998244353);
+  BenchBulk(R, 2305843009213693951ULL);
+  BenchMatrix(R, 65537, 256);
+  BenchMatrix(R, 998244353, 256);
+  BenchMatrix(R, 2305843009213693951ULL, 256);
+
+  const std::vector<FieldParams> Matrix = {
+      {2, 8, {1, 0, 1, 1, 1, 0, 0, 0, 1}},
+      {2, 16, {1, 0, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}},
+      {3, 4, {2, 1, 0, 0, 1}},
+      {65537, 2, {3, 0, 1}},
+      // 3 is a quadratic non-residue modulo 998244353.
+      {998244353, 2, {998244353 - 3, 0, 1}, false},
+  };
+  for (const auto &FP : Matrix) {
+    BenchField<FiniteField>(R, "", FP);
+    BenchGenerator<FiniteField>(R, FP);
+    BenchBatchInverse(R, FP);
+    if (FP.P == 2)
+      BenchField<BinaryFiniteField>(R, "binary/", FP);
+  }
+
+  for (std::size_t Size : {64, 1024, 8192}) {
+    BenchLongMul(R, 998244353, Size);
+    BenchLongMul(R, 1000000007, Size);
+  }
+  for (std::size_t Size : {256, 4096})
+    BenchMultipoint(R, 998244353, Size);
+
+  BenchFixedField<3, 8>(R);
+  BenchFixedField<251, 4>(R);
+  BenchFixedField<65537, 2>(R);
+  BenchFixedField<65537, 3>(R);
+
+  Gf256 F256;
+  BenchErasure(R, F256, 10, 14);
+  BenchErasure(R, F256, 6, 9);
+
+  if (Opts.Json)
+    R.printJson(std::cout);
+  return 0;
+}
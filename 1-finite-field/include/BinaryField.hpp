@@ -0,0 +1,260 @@
+#pragma once
+#include <FieldCache.hpp>
+#include <NumberTheory.hpp>
+#include <StaticPrimeField.hpp>
+#include <Stats.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace mmath {
+namespace field {
+
+// Returns the carry-less product of A and B. Uses PCLMULQDQ when the CPU
+// supports it and shift-and-xor otherwise.
+uint128_t CarrylessMul(std::uint64_t A, std::uint64_t B);
+
+// Whether CarrylessMul runs on PCLMULQDQ.
+bool HasHardwareCarrylessMul();
+
+// Polynom over F_2 with coefficients packed into 64-bit words: bit I % 64 of
+// word I / 64 is the coefficient at x^I. Has the same interface as
+// Polynom<StaticPrimeField<2>>.
+class BinaryPolynom {
+public:
+  using FieldT = StaticPrimeField<2>;
+  using CoeffT = FieldT::ElementType;
+
+private:
+  // Trailing zero words are never stored, so the zero polynom has no words.
+  std::vector<std::uint64_t> Words;
+
+  const FieldT *Field;
+
+  void normalize() {
+    while (!Words.empty() && Words.back() == 0)
+      Words.pop_back();
+  }
+
+public:
+  explicit BinaryPolynom(const FieldT *Field) : Field(Field) {}
+
+  BinaryPolynom(const FieldT *Field, const std::vector<CoeffT> &Coefficients);
+
+  static BinaryPolynom fromWords(const FieldT *Field,
+                                 std::vector<std::uint64_t> Words) {
+    BinaryPolynom Res(Field);
+    Res.Words = std::move(Words);
+    Res.normalize();
+    return Res;
+  }
+
+  BinaryPolynom(const BinaryPolynom &P) = default;
+  BinaryPolynom(BinaryPolynom &&P) = default;
+  BinaryPolynom &operator=(const BinaryPolynom &P) = default;
+  BinaryPolynom &operator=(BinaryPolynom &&P) = default;
+
+  void clear() { Words.clear(); }
+
+  std::optional<std::size_t> getDegree() const {
+    if (Words.empty())
+      return std::nullopt;
+    return 64 * (Words.size() - 1) + 63 - __builtin_clzll(Words.back());
+  }
+
+  bool isZero() const { return Words.empty(); }
+
+  bool isCoeff(CoeffT C) const {
+    if (Words.size() > 1 || (Words.size() == 1 && Words[0] > 1))
+      return false;
+    return getCoeffAt(0) == C;
+  }
+
+  // Words are always kept normalized, so this only releases unused capacity.
+  void trim() { Words.shrink_to_fit(); }
+
+  const std::vector<std::uint64_t> &getWords() const { return Words; }
+
+  void setCoeffAt(std::size_t CoeffDeg, CoeffT Coeff);
+
+  CoeffT getCoeffAt(std::size_t CoeffDeg) const {
+    if (CoeffDeg / 64 >= Words.size())
+      return CoeffT(0);
+    return CoeffT((Words[CoeffDeg / 64] >> (CoeffDeg % 64)) & 1);
+  }
+
+  BinaryPolynom sum(const BinaryPolynom &Other) const {
+    BinaryPolynom Res(*this);
+    return Res.sumInPlace(Other);
+  }
+
+  BinaryPolynom &sumInPlace(const BinaryPolynom &Other);
+
+  BinaryPolynom mul(CoeffT MulCoeff) const {
+    BinaryPolynom Res(*this);
+    return Res.mulInPlace(MulCoeff);
+  }
+
+  BinaryPolynom &mulInPlace(CoeffT MulCoeff) {
+    if (MulCoeff == CoeffT(0))
+      Words.clear();
+    return *this;
+  }
+
+  BinaryPolynom mul(const BinaryPolynom &Other) const;
+
+  BinaryPolynom &shiftDegInPlace(std::size_t Shift);
+
+  BinaryPolynom shiftDegrees(std::size_t Shift) const {
+    BinaryPolynom P(*this);
+    return P.shiftDegInPlace(Shift);
+  }
+
+  // Returns quotient and fills the Remainder polynom.
+  BinaryPolynom div(const BinaryPolynom &Divisor,
+                    BinaryPolynom &Remainder) const;
+
+  BinaryPolynom pow(std::size_t Pow) const;
+
+  void print(std::ostream &OS, char Letter = 'x') const;
+
+  void printVector(std::ostream &OS, std::size_t MaxDeg) const {
+    for (std::size_t I = 0; I < MaxDeg; I++)
+      OS << getCoeffAt(I);
+    OS << "\n";
+  }
+};
+
+// GF(2^m) with bit-packed elements. Has the same interface as
+// BasicFiniteField, but multiplies with carry-less multiplication and
+// reduces by shifts and xors. Reduction by a trinomial or pentanomial folds
+// the high part back a word at a time instead of bit by bit. Elements of
+// fields with m <= 64 are handled as single machine words internally.
+class BinaryFiniteField {
+public:
+  using ElementType = BinaryPolynom;
+
+  // Picks a sparse irreducible f(x) of degree m with FindIrredPoly.
+  BinaryFiniteField(std::uint64_t P, std::uint64_t M);
+
+  // Installs f(x) without checking it; see BasicFiniteField::setIrredPoly.
+  void setIrredPoly(const ElementType &IrredPoly);
+
+  const ElementType &getIrredPoly() const { return IrredPoly; }
+
+  // Tested on first use and cached until setIrredPoly replaces f(x).
+  bool isIrreducible() const;
+
+  // Same as BasicFiniteField::usePrimitivePoly.
+  const ElementType &usePrimitivePoly();
+
+  // Whether 2^m fits in 64 bits, which the primitive element search and the
+  // factorization of 2^m - 1 need. The arithmetic works for any m.
+  bool canSearchPrimitive() const { return Order != 0; }
+
+  // Same as BasicFiniteField::getPrimitiveElement. Without
+  // canSearchPrimitive it reports the error and aborts instead of returning
+  // a zero element.
+  const ElementType &getPrimitiveElement(bool Print = false,
+                                         bool Verbose = false,
+                                         bool AllDegs = false,
+                                         unsigned NumThreads = 1) {
+    requireSearchableOrder();
+    stats::ScopedTimer Timer(stats::Timer::PrimitiveSearch);
+    if (NumThreads > 1 && !Print)
+      calculatePrimitiveElementParallel(AllDegs, NumThreads);
+    else
+      calculatePrimitiveElement(Print, Verbose, AllDegs);
+    return Primitive;
+  }
+
+  const StaticPrimeField<2> *getPrimeField() const { return &PField; }
+
+  // Returns Element mod f(x).
+  ElementType reduce(const ElementType &Element) const;
+
+  // Returns A * B mod f(x).
+  ElementType mulMod(const ElementType &A, const ElementType &B) const;
+
+  // Returns Element^-1 mod f(x) by the extended Euclidean algorithm.
+  ElementType inverse(const ElementType &Element) const;
+
+  // Returns A / B mod f(x).
+  ElementType divide(const ElementType &A, const ElementType &B) const;
+
+  // Returns Element^Exponent mod f(x) using square-and-multiply.
+  ElementType powMod(const ElementType &Element,
+                     std::uint64_t Exponent) const;
+
+  // Returns 2^m, or 0 when it does not fit in 64 bits.
+  std::uint64_t getOrder() const { return Order; }
+
+  // Distinct prime factors of 2^m - 1. Computed on first use and cached.
+  const std::vector<std::uint64_t> &getMulGroupOrderFactors();
+
+  bool isPrimitive(const ElementType &Element, bool Print = false,
+                   bool Verbose = false);
+
+  // Same as BasicFiniteField::getCachedPrimitiveElement.
+  const ElementType &getCachedPrimitiveElement() const { return Primitive; }
+
+  // Same as BasicFiniteField::loadFrom and saveTo. There are no tables.
+  bool loadFrom(const FieldCache &Cache);
+  bool saveTo(const FieldCache &Cache);
+
+private:
+  std::uint64_t M;
+  std::uint64_t Order;
+  StaticPrimeField<2> PField;
+  // Number of words in a reduced element.
+  std::size_t NumWords;
+
+  bool HasOrderFactors = false;
+  // Whether f(x) is irreducible, once known.
+  mutable std::optional<bool> Irreducible;
+  std::vector<std::uint64_t> OrderFactors;
+
+  ElementType Primitive;
+  ElementType IrredPoly;
+  // Packed f(x), including the x^m term.
+  std::vector<std::uint64_t> IrredWords;
+  // Degrees of the terms of f(x) below x^m.
+  std::vector<std::size_t> IrredLowDegs;
+  // Whether reduction folds whole words using IrredLowDegs.
+  bool SparseIrred = false;
+  // f(x) as a single integer when m <= 64.
+  uint128_t IrredWide = 0;
+
+  using Word = std::uint64_t;
+
+  // Single-word fast path for m <= 64.
+  Word reduce128(uint128_t T) const;
+  Word mulMod64(Word A, Word B) const;
+  Word powMod64(Word Base, std::uint64_t Exponent) const;
+  bool isPrimitive64(Word Element, bool Print, bool Verbose);
+
+  // Reduces T[0, Len) in place so that only the first NumWords words may be
+  // nonzero. Scratch must hold Len words.
+  void reduceWords(Word *T, std::size_t Len, Word *Scratch) const;
+  // Out = A * B mod f(x) for elements of NumWords words. Scratch must hold
+  // 4 * NumWords words.
+  void mulModWords(const Word *A, const Word *B, Word *Out,
+                   Word *Scratch) const;
+  std::vector<Word> powModWords(std::vector<Word> Base,
+                                std::uint64_t Exponent) const;
+  std::vector<Word> toWords(const ElementType &Element) const;
+
+  // Aborts with a message unless canSearchPrimitive. Guards the entry points
+  // that need 2^m - 1, also in builds without assertions.
+  void requireSearchableOrder() const;
+  void printPower(std::uint64_t Exp, ElementType Rem, bool Verbose) const;
+  bool isPrimitiveExhaustive(const ElementType &Element, bool Print,
+                             bool Verbose) const;
+  void calculatePrimitiveElement(bool Print, bool Verbose, bool AllDegs);
+  void calculatePrimitiveElementParallel(bool AllDegs, unsigned NumThreads);
+};
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,129 @@
+#pragma once
+#include <BinaryField.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Reed-Solomon erasure coding over GF(2^8). Data is split into k shards of
+// equal length and extended by n - k parity shards so that any k of the n
+// shards recover the rest. Shard bytes are field elements, and parity is a
+// fixed linear map of the data bytes at the same offset.
+
+namespace mmath {
+namespace field {
+
+// GF(2^8) as exp/log tables of a primitive element. A byte is the element
+// whose coefficient at x^I is bit I.
+class Gf256 {
+public:
+  // Takes f(x) and the primitive element from BinaryFiniteField(2, 8).
+  Gf256();
+
+  // Uses f(x) and the primitive element of Field, which must be GF(2^8).
+  explicit Gf256(BinaryFiniteField &Field);
+
+  // f(x) including the x^8 term.
+  std::uint16_t getIrredPoly() const { return IrredPoly; }
+  std::uint8_t getPrimitive() const { return Exp[1]; }
+
+  std::uint8_t mul(std::uint8_t A, std::uint8_t B) const {
+    if (A == 0 || B == 0)
+      return 0;
+    return Exp[Log[A] + Log[B]];
+  }
+
+  std::uint8_t inverse(std::uint8_t A) const {
+    assert(A != 0 && "Zero has no inverse");
+    return Exp[255 - Log[A]];
+  }
+
+  std::uint8_t divide(std::uint8_t A, std::uint8_t B) const {
+    return mul(A, inverse(B));
+  }
+
+  // Primitive element to the power Exponent.
+  std::uint8_t exp(std::uint64_t Exponent) const {
+    return Exp[Exponent % 255];
+  }
+
+private:
+  std::uint16_t IrredPoly;
+  // Exp[I] = g^I, stored twice so that sums of two logs need no reduction.
+  std::uint8_t Exp[510];
+  // Log[g^I] = I. Log[0] is unused.
+  std::uint8_t Log[256];
+
+  void buildTables(BinaryFiniteField &Field);
+};
+
+// Row-major Rows x Cols Cauchy matrix 1 / (x_i + y_j) with x_i = Cols + i
+// and y_j = j. Every square submatrix is invertible. Needs Rows + Cols <= 256.
+std::vector<std::uint8_t> CauchyMatrix(const Gf256 &F, std::size_t Rows,
+                                       std::size_t Cols);
+
+// Row-major Rows x Cols Vandermonde matrix a_i^j with a_i = i. Any Cols rows
+// are invertible. Needs Rows <= 256.
+std::vector<std::uint8_t> VandermondeMatrix(const Gf256 &F, std::size_t Rows,
+                                            std::size_t Cols);
+
+// Inverts the row-major N x N matrix A in place by Gauss-Jordan elimination.
+// Returns false and leaves A unspecified if it is singular.
+bool InvertMatrix(const Gf256 &F, std::vector<std::uint8_t> &A,
+                  std::size_t N);
+
+// Name of the kernel set encode and reconstruct dispatch to: "avx512",
+// "avx2", "ssse3" or "scalar". The environment variable MMATH_GF256_KERNEL,
+// read once at startup, may name a lower level to use instead.
+const char *ErasureKernelName();
+
+enum class CodeMatrix {
+  // Parity rows are a Cauchy matrix.
+  Cauchy,
+  // A Vandermonde matrix brought to systematic form by the inverse of its
+  // top square.
+  Vandermonde
+};
+
+// Systematic code with k data shards and n - k parity shards. The multiply-
+// accumulate runs on PSHUFB nibble tables (SSSE3, AVX2 or AVX-512BW,
+// whichever the CPU has) with a table-driven scalar fallback.
+class ReedSolomon {
+public:
+  ReedSolomon(const Gf256 &F, std::size_t DataShards, std::size_t TotalShards,
+              CodeMatrix Kind = CodeMatrix::Cauchy);
+
+  std::size_t getDataShards() const { return K; }
+  std::size_t getParityShards() const { return N - K; }
+  std::size_t getTotalShards() const { return N; }
+
+  // Row-major (n - k) x k lower part of the generator matrix; the upper part
+  // is the identity.
+  const std::vector<std::uint8_t> &getParityMatrix() const { return Parity; }
+
+  // Fills the n - k parity buffers from the k data buffers, all Len bytes.
+  // Buffers of at least MinParallelBytes are split across NumThreads.
+  void encode(const std::uint8_t *const *Data,
+              std::uint8_t *const *ParityShards, std::size_t Len,
+              unsigned NumThreads = 1) const;
+
+  // Shards holds all n buffers of Len bytes, Present[I] tells which of them
+  // hold valid data. Rebuilds the others in place from k of the present
+  // ones. Returns false if fewer than k are present.
+  bool reconstruct(std::uint8_t *const *Shards, const bool *Present,
+                   std::size_t Len, unsigned NumThreads = 1) const;
+
+  // Stripes shorter than this stay on the calling thread.
+  static constexpr std::size_t MinParallelBytes = 1 << 16;
+
+private:
+  Gf256 F;
+  std::size_t K;
+  std::size_t N;
+  std::vector<std::uint8_t> Parity;
+  // Nibble tables of Parity, 32 bytes per coefficient.
+  std::vector<std::uint8_t> ParityTables;
+};
+
+} // namespace field
+} // namespace mmath
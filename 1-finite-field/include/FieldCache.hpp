@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// On-disk cache of the expensive per-field data: the primitive element, the
+// factorization of p^m - 1 and optionally the exp/log tables. Entries are
+// keyed by (p, m, f(x)) and memory-mapped read-only, so processes using the
+// same field share the table pages through the page cache.
+
+namespace mmath {
+namespace field {
+
+// Read-only mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+  // Returns nullptr if the file cannot be opened or mapped.
+  static std::shared_ptr<const MappedFile> open(const std::string &Path);
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  const std::uint8_t *data() const { return Data; }
+  std::size_t size() const { return Size; }
+
+private:
+  MappedFile(const std::uint8_t *Data, std::size_t Size)
+      : Data(Data), Size(Size) {}
+
+  const std::uint8_t *Data;
+  std::size_t Size;
+};
+
+// Everything a cache entry holds. Polynoms are stored as their coefficients,
+// lowest degree first.
+struct CachedField {
+  std::uint64_t P = 0;
+  std::uint64_t M = 0;
+  std::vector<std::uint64_t> IrredPoly;
+  std::vector<std::uint64_t> Primitive;
+  std::vector<std::uint64_t> OrderFactors;
+  // p^m when the tables are present, 0 otherwise. ExpTable has
+  // TableOrder - 1 entries and LogTable has TableOrder.
+  std::uint64_t TableOrder = 0;
+  const std::uint32_t *ExpTable = nullptr;
+  const std::uint32_t *LogTable = nullptr;
+  // Keeps the tables alive after a load. Unset for entries built in memory.
+  std::shared_ptr<const MappedFile> Mapping;
+};
+
+class FieldCache {
+public:
+  // Bumped on every change of the file layout, which turns all older files
+  // into misses.
+  static constexpr std::uint64_t FormatVersion = 1;
+
+  // Entries live directly in Dir, which is created on the first store.
+  explicit FieldCache(std::string Dir) : Dir(std::move(Dir)) {}
+
+  const std::string &getDir() const { return Dir; }
+
+  // File holding the entry for (P, M, IrredPoly).
+  std::string pathFor(std::uint64_t P, std::uint64_t M,
+                      const std::vector<std::uint64_t> &IrredPoly) const;
+
+  // Maps the entry for the key. Missing files, older versions, checksum
+  // failures and entries for another key all count as misses, and the next
+  // store replaces them.
+  std::optional<CachedField>
+  load(std::uint64_t P, std::uint64_t M,
+       const std::vector<std::uint64_t> &IrredPoly) const;
+
+  // Writes Entry to a temporary file and renames it over the old one, so
+  // readers never see a partial entry. Returns false on I/O errors.
+  bool store(const CachedField &Entry) const;
+
+private:
+  std::string Dir;
+};
+
+} // namespace field
+} // namespace mmath
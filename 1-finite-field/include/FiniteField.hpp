@@ -1,11 +1,24 @@
 #pragma once
+#include <FieldCache.hpp>
+#include <Irreducibility.hpp>
+#include <NumberTheory.hpp>
+#include <ParallelSearch.hpp>
+#include <PolyReducer.hpp>
 #include <Polynom.hpp>
 #include <PrimeField.hpp>
+#include <StaticPrimeField.hpp>
+#include <Stats.hpp>
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace mmath {
 namespace field {
@@ -22,38 +35,390 @@ public:
   static PrimitiveTypeWrapper<T> zero() { return T(0); }
 };
 
-class FiniteField {
+// PrimeFieldT is either the runtime PrimeField or a StaticPrimeField<P>.
+template <class PrimeFieldT> class BasicFiniteField {
 public:
   // Elements of the Galua field are polynoms with coeffs from F_p and degree
   // up to (m - 1).
-  using ElementType = Polynom<PrimeField>;
+  using ElementType = Polynom<PrimeFieldT>;
 
-  FiniteField(std::uint64_t P, std::uint64_t M)
-      : P(P), M(M), PField(P), Primitive(&PField), IrredPoly(&PField) {}
+  // Picks a sparse irreducible f(x) of degree m with FindIrredPoly, which
+  // setIrredPoly can later replace.
+  BasicFiniteField(std::uint64_t P, std::uint64_t M)
+      : P(P), M(M), Order(IntPow(P, M)), PField(P),
+        Primitive(&PField), IrredPoly(&PField) {
+    FindIrredPoly(*this, M);
+    Irreducible = true;
+  }
 
+  // Installs f(x) without checking it, so that reducible polynoms can still be
+  // experimented with. Call isIrreducible to validate user input.
   void setIrredPoly(const ElementType &IrredPoly) {
     this->IrredPoly = IrredPoly;
+    Reducer = PolyReducer<PrimeFieldT>(&PField, IrredPoly);
+    Primitive = ElementType(&PField);
+    Irreducible.reset();
+    releaseLogTables();
+  }
+
+  const ElementType &getIrredPoly() const { return IrredPoly; }
+
+  // Tested on first use and cached until setIrredPoly replaces f(x).
+  bool isIrreducible() const {
+    if (!Irreducible)
+      Irreducible = IsIrreducible(*this);
+    return *Irreducible;
+  }
+
+  // Replaces f(x) with a primitive polynom, for which x itself is a primitive
+  // element. Needs the factorization of p^m - 1.
+  const ElementType &usePrimitivePoly() {
+    FindIrredPoly(*this, M, true);
+    Irreducible = true;
+    return IrredPoly;
   }
 
+  // Searches candidates in ElementGenerator order and returns the first
+  // primitive one. With NumThreads > 1 the candidates are checked in parallel;
+  // printing forces the serial search so the trace stays in order.
   const ElementType &getPrimitiveElement(bool Print = false,
                                          bool Verbose = false,
-                                         bool AllDegs = false) {
-    calculatePrimitiveElement(Print, Verbose, AllDegs);
+                                         bool AllDegs = false,
+                                         unsigned NumThreads = 1) {
+    stats::ScopedTimer Timer(stats::Timer::PrimitiveSearch);
+    if (NumThreads > 1 && !Print)
+      calculatePrimitiveElementParallel(AllDegs, NumThreads);
+    else
+      calculatePrimitiveElement(Print, Verbose, AllDegs);
     return Primitive;
   }
 
-  const PrimeField *getPrimeField() const { return &PField; }
+  const PrimeFieldT *getPrimeField() const { return &PField; }
+
+  // Returns Element mod f(x).
+  ElementType reduce(const ElementType &Element) const {
+    return Reducer.reduce(Element);
+  }
+
+  const PolyReducer<PrimeFieldT> &getReducer() const { return Reducer; }
+
+  // Returns Element^Exponent mod f(x) using square-and-multiply, reducing
+  // after every multiplication so intermediates never exceed degree 2m - 2.
+  // Products go to a scratch polynom swapped with the target, so for short
+  // f(x) the loop stops allocating after its first steps.
+  ElementType powMod(const ElementType &Element,
+                     std::uint64_t Exponent) const {
+    ElementType Res = reduce(ElementType(&PField, {PField.one()}));
+    ElementType Base = reduce(Element);
+    ElementType Tmp(&PField);
+    while (Exponent) {
+      if (Exponent & 1)
+        mulModInto(Res, Base, Tmp);
+      Exponent >>= 1;
+      if (Exponent)
+        mulModInto(Base, Base, Tmp);
+    }
+    return Res;
+  }
+
+  // Returns Element^-1 mod f(x), the Bezout cofactor of Element and f(x).
+  // Costs O(M(m) log m) instead of the O(m log p) multiplications of
+  // powMod(Element, p^m - 2).
+  ElementType inverse(const ElementType &Element) const {
+    auto A = reduce(Element);
+    assert(!A.isZero() && "Zero has no inverse");
+    ElementType S(&PField), T(&PField);
+    auto G = A.xgcd(IrredPoly, S, T);
+    assert(G.isCoeff(PField.one()) &&
+           "Element shares a factor with a reducible f(x)");
+    return S;
+  }
+
+  // Returns A / B mod f(x).
+  ElementType divide(const ElementType &A, const ElementType &B) const {
+    auto Res = reduce(A).mul(inverse(B));
+    Reducer.reduceInPlace(Res);
+    return Res;
+  }
+
+  // Out[I] = Elements[I]^-1 mod f(x), with zeros mapped to zero. Takes one
+  // inverse and 3 (Count - 1) multiplications mod f(x) by Montgomery's
+  // trick. Out may alias Elements. Products are built in place in the prefix
+  // buffer or in a scratch polynom swapped with Out[I], and elements are only
+  // copied when they still need reducing.
+  void inverse(ElementType *Out, const ElementType *Elements,
+               std::size_t Count) const {
+    if (Count == 0)
+      return;
+    ElementType Scratch(&PField), Tmp(&PField);
+    auto Reduced = [&](std::size_t I) -> const ElementType & {
+      if (Elements[I].getCoeffs().size() <= Reducer.getModulusDegree())
+        return Elements[I];
+      Scratch = Elements[I];
+      Reducer.reduceInPlace(Scratch);
+      return Scratch;
+    };
+
+    // Prefix[I] is the product of the nonzero Elements[0..I] mod f(x).
+    std::vector<ElementType> Prefix(Count, ElementType(&PField));
+    auto One = reduce(ElementType(&PField, {PField.one()}));
+    for (std::size_t I = 0; I < Count; I++) {
+      const auto &Prev = I ? Prefix[I - 1] : One;
+      const auto &Element = Reduced(I);
+      if (Element.isZero()) {
+        Prefix[I] = Prev;
+        continue;
+      }
+      Prefix[I].assignMul(Prev, Element);
+      Reducer.reduceInPlace(Prefix[I]);
+    }
+
+    auto Inv = inverse(Prefix[Count - 1]);
+    for (std::size_t I = Count; I-- > 0;) {
+      const auto &Element = Reduced(I);
+      if (Element.isZero()) {
+        Out[I] = ElementType(&PField);
+        continue;
+      }
+      if (I == 0) {
+        Out[I] = std::move(Inv);
+        break;
+      }
+      Tmp.assignMul(Inv, Prefix[I - 1]);
+      Reducer.reduceInPlace(Tmp);
+      // Prefix[I] is no longer needed and serves as scratch.
+      mulModInto(Inv, Element, Prefix[I]);
+      std::swap(Out[I], Tmp);
+    }
+  }
+
+  std::uint64_t getOrder() const { return Order; }
+
+  // Distinct prime factors of p^m - 1, the order of the multiplicative group.
+  // Computed on first use and cached.
+  const std::vector<std::uint64_t> &getMulGroupOrderFactors() {
+    if (!HasOrderFactors) {
+      stats::ScopedTimer Timer(stats::Timer::OrderFactorization);
+      OrderFactors = Factorize(Order - 1);
+      HasOrderFactors = true;
+    }
+    return OrderFactors;
+  }
+
+  // Element is primitive iff Element^((p^m - 1) / q) != 1 for every prime q
+  // dividing p^m - 1 and Element^(p^m - 1) == 1. The last check is implied
+  // when f(x) is irreducible and Element is nonzero, so it only runs for a
+  // reducible f(x), whose zero divisors would otherwise pass the test, and
+  // when tracing.
+  bool isPrimitive(const ElementType &Element, bool Print = false,
+                   bool Verbose = false) {
+    if (reduce(Element).isZero())
+      return false;
+    for (auto Q : getMulGroupOrderFactors()) {
+      auto Exp = (Order - 1) / Q;
+      auto Rem = powMod(Element, Exp);
+      if (Print)
+        printPower(Exp, Rem, Verbose);
+      if (Rem.isCoeff(PField.one()))
+        return false;
+    }
+    if (!Print && isIrreducible())
+      return true;
+    auto Rem = powMod(Element, Order - 1);
+    if (Print)
+      printPower(Order - 1, Rem, Verbose);
+    return Rem.isCoeff(PField.one());
+  }
+
+  // Compact representation of an element: its coefficients read as the digits
+  // of a base-p number, lowest degree first. Used with the exp/log tables.
+  using ElementHandle = std::uint32_t;
+
+  // Largest field order for which exp/log tables may be built. The tables take
+  // 8 bytes per element.
+  static constexpr std::uint64_t MaxLogTableOrder = 1 << 24;
 
-  std::uint64_t getOrder() const { return P * M; }
+  // Builds tables of the powers of the primitive element and of the discrete
+  // logarithm of every nonzero element, so that the table* operations below
+  // become lookups. Finds the primitive element first if needed. Returns the
+  // time spent in milliseconds.
+  double buildLogTables() {
+    stats::ScopedTimer Timer(stats::Timer::LogTables);
+    auto Start = std::chrono::high_resolution_clock::now();
+    assert(Order <= MaxLogTableOrder && "Field is too large for log tables");
+    assert(IrredPoly.getDegree() == M && "f(x) must have degree m");
+    if (Primitive.isZero())
+      calculatePrimitiveElement(false, false, false);
+    assert(!Primitive.isZero() && "f(x) must be irreducible");
+
+    auto Zero = PField.zero();
+    // x^m = -(f_0 + ... + f_{m-1} x^{m-1}) / f_m mod f(x).
+    auto LeadInv = IrredPoly.getCoeffAt(M).inverseMul();
+    std::vector<CoeffT> NegLow;
+    NegLow.reserve(M);
+    for (std::size_t I = 0; I < M; I++)
+      NegLow.push_back((IrredPoly.getCoeffAt(I) * LeadInv).inverseSum());
+    auto Gen = reduce(Primitive);
+
+    std::vector<CoeffT> Cur(M, Zero), Acc(M, Zero), Shifted(M, Zero);
+    Cur[0] = PField.one();
+    ExpTable.resize(Order - 1);
+    LogTable.assign(Order, 0);
+    for (std::uint64_t I = 0; I + 1 < Order; I++) {
+      auto H = encodeCoeffs(Cur);
+      ExpTable[I] = H;
+      LogTable[H] = static_cast<ElementHandle>(I);
+      // Cur = Cur * Gen mod f(x), as a sum of Gen_j * Cur * x^j.
+      std::fill(Acc.begin(), Acc.end(), Zero);
+      Shifted = Cur;
+      for (std::size_t J = 0; J < Gen.getCoeffs().size(); J++) {
+        if (J != 0) {
+          auto Top = Shifted[M - 1];
+          for (std::size_t K = M - 1; K > 0; K--)
+            Shifted[K] = Shifted[K - 1];
+          Shifted[0] = Zero;
+          for (std::size_t K = 0; K < M; K++)
+            Shifted[K] += Top * NegLow[K];
+        }
+        const auto &GenC = Gen.getCoeffs()[J];
+        if (GenC != Zero)
+          for (std::size_t K = 0; K < M; K++)
+            Acc[K] += GenC * Shifted[K];
+      }
+      std::swap(Cur, Acc);
+    }
+
+    ExpData = ExpTable.data();
+    LogData = LogTable.data();
+    TableMapping.reset();
+
+    std::chrono::duration<double, std::milli> Elapsed =
+        std::chrono::high_resolution_clock::now() - Start;
+    return Elapsed.count();
+  }
+
+  bool hasLogTables() const { return ExpData != nullptr; }
+
+  void releaseLogTables() {
+    ExpTable = {};
+    LogTable = {};
+    ExpData = LogData = nullptr;
+    TableMapping.reset();
+  }
+
+  // Primitive element found by the last search or restored by loadFrom, zero
+  // if there is none yet.
+  const ElementType &getCachedPrimitiveElement() const { return Primitive; }
+
+  // Restores the primitive element, the factorization of p^m - 1 and, when
+  // the entry has them, the exp/log tables for the current f(x). The tables
+  // are used in place from the read-only mapping. Returns false on a miss.
+  bool loadFrom(const FieldCache &Cache) {
+    auto Entry = Cache.load(P, M, coeffWords(IrredPoly));
+    if (!Entry || Entry->Primitive.empty())
+      return false;
+    Primitive = detail::MakePoly(*this, Entry->Primitive);
+    OrderFactors = std::move(Entry->OrderFactors);
+    HasOrderFactors = true;
+    releaseLogTables();
+    if (Entry->TableOrder == Order) {
+      ExpData = Entry->ExpTable;
+      LogData = Entry->LogTable;
+      TableMapping = std::move(Entry->Mapping);
+    }
+    return true;
+  }
+
+  // Stores what loadFrom restores, with the tables only if they are built.
+  // Finds the primitive element first if needed. Returns false if there is
+  // none, which means f(x) is reducible, or on I/O errors.
+  bool saveTo(const FieldCache &Cache) {
+    if (Primitive.isZero())
+      calculatePrimitiveElement(false, false, false);
+    if (Primitive.isZero())
+      return false;
+    CachedField Entry;
+    Entry.P = P;
+    Entry.M = M;
+    Entry.IrredPoly = coeffWords(IrredPoly);
+    Entry.Primitive = coeffWords(Primitive);
+    Entry.OrderFactors = getMulGroupOrderFactors();
+    if (hasLogTables()) {
+      Entry.TableOrder = Order;
+      Entry.ExpTable = ExpData;
+      Entry.LogTable = LogData;
+    }
+    return Cache.store(Entry);
+  }
+
+  ElementHandle toHandle(const ElementType &Element) const {
+    auto Rem = reduce(Element);
+    std::vector<CoeffT> Coeffs(M, PField.zero());
+    for (std::size_t I = 0; I < Rem.getCoeffs().size(); I++)
+      Coeffs[I] = Rem.getCoeffs()[I];
+    return encodeCoeffs(Coeffs);
+  }
+
+  ElementType fromHandle(ElementHandle H) const { return getElementAt(H); }
+
+  // Returns the element ElementGenerator yields at position Index.
+  ElementType getElementAt(std::uint64_t Index) const {
+    std::vector<CoeffT> Coeffs;
+    Coeffs.reserve(M);
+    for (std::size_t I = 0; I < M; I++, Index /= P)
+      Coeffs.emplace_back(Index % P, &PField);
+    return ElementType(&PField, std::move(Coeffs));
+  }
+
+  // Adds coefficient-wise, which is XOR for p = 2. Needs no tables.
+  ElementHandle tableAdd(ElementHandle A, ElementHandle B) const {
+    if (P == 2)
+      return A ^ B;
+    ElementHandle Res = 0;
+    for (ElementHandle Digit = 1; A || B; Digit *= P, A /= P, B /= P) {
+      auto Sum = A % P + B % P;
+      Res += static_cast<ElementHandle>((Sum >= P ? Sum - P : Sum) * Digit);
+    }
+    return Res;
+  }
+
+  ElementHandle tableMul(ElementHandle A, ElementHandle B) const {
+    assert(hasLogTables() && "Call buildLogTables first");
+    if (A == 0 || B == 0)
+      return 0;
+    std::uint64_t Log = std::uint64_t(LogData[A]) + LogData[B];
+    if (Log >= Order - 1)
+      Log -= Order - 1;
+    return ExpData[Log];
+  }
+
+  ElementHandle tableInverse(ElementHandle A) const {
+    assert(hasLogTables() && "Call buildLogTables first");
+    assert(A != 0 && "Zero has no inverse");
+    auto Log = LogData[A];
+    return ExpData[Log == 0 ? 0 : Order - 1 - Log];
+  }
+
+  ElementHandle tableDiv(ElementHandle A, ElementHandle B) const {
+    return tableMul(A, tableInverse(B));
+  }
+
+  ElementHandle tablePow(ElementHandle A, std::uint64_t Exponent) const {
+    assert(hasLogTables() && "Call buildLogTables first");
+    if (A == 0)
+      return Exponent == 0 ? 1 : 0;
+    auto Log = uint128_t(LogData[A]) * Exponent % (Order - 1);
+    return ExpData[static_cast<std::size_t>(Log)];
+  }
 
   struct ElementGenerator {
-    std::vector<PrimeField::ElementType> Coeffs;
-    const PrimeField::ElementType Zero;
-    const PrimeField::ElementType One;
-    const FiniteField *F;
+    std::vector<typename PrimeFieldT::ElementType> Coeffs;
+    const typename PrimeFieldT::ElementType Zero;
+    const typename PrimeFieldT::ElementType One;
+    const BasicFiniteField *F;
     bool HitZero = false;
 
-    ElementGenerator(const FiniteField *F)
+    ElementGenerator(const BasicFiniteField *F)
         : F(F), Zero(F->PField.zero()), One(F->PField.one()) {
       Coeffs.reserve(F->M);
       for (std::size_t Pos = 0; Pos < F->M; Pos++)
@@ -61,7 +426,7 @@ public:
     }
 
     ElementType next() {
-      Polynom<PrimeField> P(&F->PField, Coeffs);
+      ElementType P(&F->PField, Coeffs);
       std::size_t i;
       for (i = 0; i < F->M; i++) {
         auto &NewC = Coeffs.at(i).sumInPlace(One);
@@ -77,42 +442,91 @@ public:
 private:
   std::uint64_t P;
   std::uint64_t M;
-  PrimeField PField;
+  std::uint64_t Order;
+  PrimeFieldT PField;
+
+  bool HasOrderFactors = false;
+  std::vector<std::uint64_t> OrderFactors;
+  // Whether f(x) is irreducible, once known.
+  mutable std::optional<bool> Irreducible;
 
   ElementType Primitive;
   ElementType IrredPoly;
+  PolyReducer<PrimeFieldT> Reducer;
+
+  // ExpTable[I] = g^I and LogTable[g^I] = I for the primitive element g.
+  std::vector<ElementHandle> ExpTable;
+  std::vector<ElementHandle> LogTable;
+  // The tables in use: either the vectors above or a cache file mapping,
+  // which TableMapping keeps alive.
+  const ElementHandle *ExpData = nullptr;
+  const ElementHandle *LogData = nullptr;
+  std::shared_ptr<const MappedFile> TableMapping;
+
+  using CoeffT = typename ElementType::CoeffT;
+
+  std::vector<std::uint64_t> coeffWords(const ElementType &Element) const {
+    return std::vector<std::uint64_t>(Element.getCoeffs().begin(),
+                                      Element.getCoeffs().end());
+  }
+
+  ElementHandle encodeCoeffs(const std::vector<CoeffT> &Coeffs) const {
+    std::uint64_t H = 0;
+    for (std::size_t I = Coeffs.size(); I > 0; I--)
+      H = H * P + std::uint64_t(Coeffs[I - 1]);
+    return static_cast<ElementHandle>(H);
+  }
 
   friend struct ElementGenerator;
 
+  // A = A * B mod f(x), with the product built in Tmp and swapped in.
+  void mulModInto(ElementType &A, const ElementType &B,
+                  ElementType &Tmp) const {
+    Tmp.assignMul(A, B);
+    Reducer.reduceInPlace(Tmp);
+    std::swap(A, Tmp);
+  }
+
+  void printPower(std::uint64_t Exp, ElementType &Rem, bool Verbose) const {
+    std::cout << "P^" << Exp << " mod f(x) = ";
+    if (Verbose)
+      Rem.print(std::cout);
+    else {
+      Rem.trim();
+      Rem.printVector(std::cout, M);
+    }
+  }
+
+  // Checks every power of Element up to p^m - 1 and reports it primitive only
+  // if none of them but the last is 1. Used to verify the factorization-based
+  // test.
+  bool isPrimitiveExhaustive(const ElementType &Element, bool Print,
+                             bool Verbose) const {
+    ElementType Base = reduce(Element);
+    ElementType Rem = reduce(ElementType(&PField, {PField.one()}));
+    ElementType Tmp(&PField);
+    std::uint64_t I;
+    for (I = 0; I < Order; I++) {
+      if (I != 0)
+        mulModInto(Rem, Base, Tmp);
+      if (Print)
+        printPower(I, Rem, Verbose);
+      if (I != 0 && Rem.isCoeff(PField.one()))
+        break;
+    }
+    return I == Order - 1;
+  }
+
   void calculatePrimitiveElement(bool Print, bool Verbose, bool AllDegs) {
     ElementGenerator Gen(this);
     bool FoundPrim = false;
     while (!Gen.HitZero && !FoundPrim) {
       auto Poly = Gen.next();
-      auto PM = pow(P, M);
-      ElementType Rem(&PField);
-      ElementType Pow(&PField);
-      std::size_t I;
-      for (I = 0; I < PM; I++) {
-        if (!AllDegs && (I == 0 || (std::size_t(PM) - 1) % I != 0))
-          continue;
-        Pow = Poly.pow(I);
-        Rem.clear();
-        auto Ignore = Pow.div(IrredPoly, Rem);
-        if (Print) {
-          std::cout << "P^" << I << " mod f(x) = ";
-          if (Verbose)
-            Rem.print(std::cout);
-          else {
-            Rem.trim();
-            Rem.printVector(std::cout, M);
-          }
-        }
-        if (I != 0 && Rem.isCoeff(PField.one()))
-          break;
-      }
-      if (I == PM - 1) {
-        FoundPrim = true;
+      if (AllDegs)
+        FoundPrim = isPrimitiveExhaustive(Poly, Print, Verbose);
+      else
+        FoundPrim = isPrimitive(Poly, Print, Verbose);
+      if (FoundPrim) {
         Primitive = Poly;
         if (Print)
           std::cout << "P is primitive!\n";
@@ -121,7 +535,22 @@ private:
         std::cout << "\n";
     }
   }
+
+  void calculatePrimitiveElementParallel(bool AllDegs, unsigned NumThreads) {
+    // Fill the caches up front so workers only read them.
+    getMulGroupOrderFactors();
+    isIrreducible();
+    auto Index = FindFirstParallel(Order, NumThreads, [&](std::uint64_t I) {
+      auto Poly = getElementAt(I);
+      return AllDegs ? isPrimitiveExhaustive(Poly, false, false)
+                     : isPrimitive(Poly);
+    });
+    if (Index != Order)
+      Primitive = getElementAt(Index);
+  }
 };
 
+using FiniteField = BasicFiniteField<PrimeField>;
+
 } // namespace field
 } // namespace mmath
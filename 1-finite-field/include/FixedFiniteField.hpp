@@ -0,0 +1,304 @@
+#pragma once
+#include <FiniteField.hpp>
+#include <FixedPolynom.hpp>
+#include <NumberTheory.hpp>
+#include <ParallelSearch.hpp>
+#include <Polynom.hpp>
+#include <StaticPrimeField.hpp>
+#include <Stats.hpp>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace mmath {
+namespace field {
+
+// GF(P^M) with both P and M known at compile time, for the small fields that
+// BasicFiniteField handles with heap-backed polynoms. Elements are
+// FixedPolynom<StaticPrimeField<P>, M>: M residues and nothing else. With the
+// loop bounds fixed, the compiler unrolls and vectorizes mulMod completely.
+//
+// f(x) can be taken from a BasicFiniteField, which also finds one.
+template <std::uint64_t P, std::size_t M> class FixedFiniteField {
+  static_assert(M >= 1, "Extension degree must be positive");
+
+  static constexpr std::uint64_t computeOrder() {
+    std::uint64_t Res = 1;
+    for (std::size_t I = 0; I < M; I++) {
+      if (Res > std::numeric_limits<std::uint64_t>::max() / P)
+        return 0;
+      Res *= P;
+    }
+    return Res;
+  }
+
+public:
+  using PrimeFieldT = StaticPrimeField<P>;
+  using ElementType = FixedPolynom<PrimeFieldT, M>;
+  using CoeffT = typename ElementType::CoeffT;
+  static_assert(std::is_trivially_copyable<ElementType>::value,
+                "Elements must be plain arrays of residues");
+
+  static constexpr std::uint64_t Order = computeOrder();
+  static_assert(Order != 0, "p^m must fit in 64 bits");
+
+  // Picks f(x) with FindIrredPoly, as BasicFiniteField(P, M) does.
+  FixedFiniteField() : FixedFiniteField(BasicFiniteField<PrimeFieldT>(P, M)) {}
+
+  // Uses the f(x) of Field, which must be GF(P^M).
+  explicit FixedFiniteField(const BasicFiniteField<PrimeFieldT> &Field) {
+    setIrredPoly(Field.getIrredPoly());
+  }
+
+  explicit FixedFiniteField(const Polynom<PrimeFieldT> &IrredPoly) {
+    setIrredPoly(IrredPoly);
+  }
+
+  // Installs f(x), which must have degree M, and tests whether it is
+  // irreducible. It is stored divided by its leading coefficient, which
+  // leaves the residues unchanged.
+  void setIrredPoly(const Polynom<PrimeFieldT> &IrredPoly) {
+    assert(IrredPoly.getDegree() == M && "f(x) must have degree M");
+    auto LeadInv = IrredPoly.getCoeffAt(M).inverseMul();
+    // x^M = -f_0 - f_1 x - ... - f_{M-1} x^(M-1) mod f(x).
+    std::array<CoeffT, M> Top{};
+    for (std::size_t J = 0; J < M; J++) {
+      IrredLow.setCoeffAt(J, IrredPoly.getCoeffAt(J) * LeadInv);
+      Top[J] = IrredLow.getCoeffAt(J).inverseSum();
+    }
+    // Fold[K] = x^(M + K) mod f(x), the previous row times x.
+    for (std::size_t K = 0; K + 1 < M; K++) {
+      if (K == 0) {
+        Fold[K] = Top;
+        continue;
+      }
+      auto Carry = Fold[K - 1][M - 1];
+      for (std::size_t J = 0; J < M; J++)
+        Fold[K][J] = (J ? Fold[K - 1][J - 1] : CoeffT(0)) + Carry * Top[J];
+    }
+    Irreducible = checkIrreducible();
+  }
+
+  bool isIrreducible() const { return Irreducible; }
+
+  // Monic f(x).
+  Polynom<PrimeFieldT> getIrredPoly() const {
+    std::vector<CoeffT> Coeffs(IrredLow.getCoeffs().begin(),
+                               IrredLow.getCoeffs().end());
+    Coeffs.push_back(CoeffT(1));
+    return Polynom<PrimeFieldT>(&PField, std::move(Coeffs));
+  }
+
+  static const PrimeFieldT *getPrimeField() { return &PField; }
+
+  static constexpr std::uint64_t getOrder() { return Order; }
+
+  // Element mod f(x).
+  ElementType reduce(const Polynom<PrimeFieldT> &Poly) const {
+    auto Coeffs = Poly.getCoeffs();
+    for (std::size_t I = Coeffs.size(); I-- > M;) {
+      auto C = Coeffs[I];
+      for (std::size_t J = 0; J < M; J++)
+        Coeffs[I - M + J] += C * IrredLow.getCoeffAt(J).inverseSum();
+    }
+    ElementType Res;
+    for (std::size_t I = 0; I < M && I < Coeffs.size(); I++)
+      Res.setCoeffAt(I, Coeffs[I]);
+    return Res;
+  }
+
+  // Polynoms passed to a BasicFiniteField must refer to its prime field.
+  Polynom<PrimeFieldT> toPolynom(const ElementType &Element,
+                                 const PrimeFieldT *Field = &PField) const {
+    return Element.toPolynom(Field);
+  }
+
+  static ElementType one() {
+    ElementType Res;
+    Res.setCoeffAt(0, CoeffT(1));
+    return Res;
+  }
+
+  // Returns A * B mod f(x). The product coefficients are reduced by the
+  // precomputed x^(M + K) mod f(x) rows, so every output coefficient is an
+  // independent sum. When (2M - 1) (P - 1)^2 fits in 64 bits the sums are
+  // accumulated unreduced and taken mod P once per coefficient.
+  ElementType mulMod(const ElementType &A, const ElementType &B) const {
+    ElementType Res;
+    if constexpr (LazyReduction) {
+      stats::count(stats::Counter::FieldMul, (2 * M - 1) * M);
+      stats::count(stats::Counter::FieldAdd, (2 * M - 1) * M);
+      std::uint64_t Prod[2 * M - 1] = {};
+      for (std::size_t I = 0; I < M; I++)
+        for (std::size_t J = 0; J < M; J++)
+          Prod[I + J] +=
+              std::uint64_t(A.getCoeffAt(I)) * std::uint64_t(B.getCoeffAt(J));
+      for (std::size_t K = M; K < 2 * M - 1; K++)
+        Prod[K] %= P;
+      for (std::size_t J = 0; J < M; J++) {
+        auto Acc = Prod[J];
+        for (std::size_t K = 0; K + 1 < M; K++)
+          Acc += Prod[M + K] * std::uint64_t(Fold[K][J]);
+        Res.setCoeffAt(J, CoeffT(Acc));
+      }
+    } else {
+      std::array<CoeffT, 2 * M - 1> Prod{};
+      for (std::size_t I = 0; I < M; I++)
+        for (std::size_t J = 0; J < M; J++)
+          Prod[I + J] += A.getCoeffAt(I) * B.getCoeffAt(J);
+      for (std::size_t J = 0; J < M; J++) {
+        auto Acc = Prod[J];
+        for (std::size_t K = 0; K + 1 < M; K++)
+          Acc += Prod[M + K] * Fold[K][J];
+        Res.setCoeffAt(J, Acc);
+      }
+    }
+    return Res;
+  }
+
+  // Returns Element^Exponent mod f(x) using square-and-multiply.
+  ElementType powMod(const ElementType &Element,
+                     std::uint64_t Exponent) const {
+    auto Res = one();
+    auto Base = Element;
+    while (Exponent) {
+      if (Exponent & 1)
+        Res = mulMod(Res, Base);
+      Exponent >>= 1;
+      if (Exponent)
+        Base = mulMod(Base, Base);
+    }
+    return Res;
+  }
+
+  // Returns Element^-1 as Element^(p^m - 2). With fixed M this beats the
+  // allocating extended Euclid of BasicFiniteField::inverse, but the result
+  // is only an inverse when f(x) is irreducible.
+  ElementType inverse(const ElementType &Element) const {
+    assert(!Element.isZero() && "Zero has no inverse");
+    return powMod(Element, Order - 2);
+  }
+
+  ElementType divide(const ElementType &A, const ElementType &B) const {
+    return mulMod(A, inverse(B));
+  }
+
+  // Out[I] = Elements[I]^-1 mod f(x), with zeros mapped to zero, by
+  // Montgomery's trick. Out may alias Elements.
+  void inverse(ElementType *Out, const ElementType *Elements,
+               std::size_t Count) const {
+    if (Count == 0)
+      return;
+    std::vector<ElementType> Prefix(Count);
+    auto Acc = one();
+    for (std::size_t I = 0; I < Count; I++) {
+      if (!Elements[I].isZero())
+        Acc = mulMod(Acc, Elements[I]);
+      Prefix[I] = Acc;
+    }
+    auto Inv = inverse(Acc);
+    for (std::size_t I = Count; I-- > 0;) {
+      if (Elements[I].isZero()) {
+        Out[I] = ElementType();
+        continue;
+      }
+      auto Element = Elements[I];
+      Out[I] = I ? mulMod(Inv, Prefix[I - 1]) : Inv;
+      Inv = mulMod(Inv, Element);
+    }
+  }
+
+  // Distinct prime factors of p^m - 1. Computed on first use and cached.
+  const std::vector<std::uint64_t> &getMulGroupOrderFactors() {
+    if (!HasOrderFactors) {
+      stats::ScopedTimer Timer(stats::Timer::OrderFactorization);
+      OrderFactors = Factorize(Order - 1);
+      HasOrderFactors = true;
+    }
+    return OrderFactors;
+  }
+
+  // Same test as BasicFiniteField::isPrimitive.
+  bool isPrimitive(const ElementType &Element) {
+    if (Element.isZero())
+      return false;
+    for (auto Q : getMulGroupOrderFactors())
+      if (powMod(Element, (Order - 1) / Q).isCoeff(CoeffT(1)))
+        return false;
+    if (Irreducible)
+      return true;
+    return powMod(Element, Order - 1).isCoeff(CoeffT(1));
+  }
+
+  // The element with the base-p digits of Index as coefficients, lowest
+  // degree first, as in BasicFiniteField::getElementAt.
+  static ElementType getElementAt(std::uint64_t Index) {
+    ElementType Res;
+    for (std::size_t I = 0; I < M; I++, Index /= P)
+      Res.setCoeffAt(I, CoeffT(Index % P));
+    return Res;
+  }
+
+  // The first primitive element in getElementAt order, which is the one
+  // BasicFiniteField::getPrimitiveElement finds for the same f(x).
+  ElementType getPrimitiveElement(unsigned NumThreads = 1) {
+    stats::ScopedTimer Timer(stats::Timer::PrimitiveSearch);
+    getMulGroupOrderFactors();
+    std::uint64_t Index = 0;
+    if (NumThreads > 1)
+      Index = FindFirstParallel(Order, NumThreads, [&](std::uint64_t I) {
+        return isPrimitive(getElementAt(I));
+      });
+    else
+      while (Index < Order && !isPrimitive(getElementAt(Index)))
+        Index++;
+    assert(Index != Order && "f(x) must be irreducible");
+    return getElementAt(Index);
+  }
+
+private:
+  static constexpr PrimeFieldT PField{};
+
+  // Whether mulMod may sum 2M - 1 products of residues without overflow.
+  static constexpr bool LazyReduction =
+      P - 1 <= std::numeric_limits<std::uint64_t>::max() / (2 * M - 1) /
+                   (P - 1);
+
+  // The lower coefficients of the monic f(x).
+  ElementType IrredLow;
+  // Fold[K][J] is the coefficient at x^J of x^(M + K) mod f(x).
+  std::array<std::array<CoeffT, M>, M - 1> Fold{};
+
+  bool Irreducible = false;
+  bool HasOrderFactors = false;
+  std::vector<std::uint64_t> OrderFactors;
+
+  // Rabin's test as in IsIrreducible, with the powers of x taken by mulMod.
+  bool checkIrreducible() const {
+    std::vector<std::size_t> Checkpoints;
+    for (auto Q : Factorize(M))
+      Checkpoints.push_back(M / Q);
+    auto IrredPoly = getIrredPoly();
+    auto X = reduce(Polynom<PrimeFieldT>(&PField, {CoeffT(0), CoeffT(1)}));
+    auto H = X;
+    for (std::size_t K = 1; K <= M; K++) {
+      H = powMod(H, P);
+      for (auto C : Checkpoints) {
+        if (C != K)
+          continue;
+        auto Diff = H - X;
+        if (Diff.isZero() ||
+            IrredPoly.gcd(toPolynom(Diff)).getDegree().value_or(0) > 0)
+          return false;
+      }
+    }
+    return H == X;
+  }
+};
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,153 @@
+#pragma once
+#include <Polynom.hpp>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace mmath {
+
+// Polynom of degree < N with its coefficients in an inline array instead of
+// a heap vector. Coefficients above the degree are kept as zeros rather than
+// trimmed. FieldT must hold no state, as StaticPrimeField does, so that
+// coefficients need no field pointer: the whole polynom is N residues and is
+// trivially copyable, and a std::vector of them is one flat array.
+template <class FieldT, std::size_t N> class FixedPolynom {
+  static_assert(std::is_empty<FieldT>::value,
+                "Coefficients must not refer to a field object");
+  static_assert(N > 0, "Must hold at least one coefficient");
+
+public:
+  using FieldType = FieldT;
+  using CoeffT = typename FieldT::ElementType;
+
+  static constexpr std::size_t Size = N;
+
+  // The zero polynom.
+  constexpr FixedPolynom() : Coeffs{} {}
+
+  explicit FixedPolynom(const std::array<CoeffT, N> &Coeffs)
+      : Coeffs(Coeffs) {}
+
+  explicit FixedPolynom(const Polynom<FieldT> &Poly) : Coeffs{} {
+    assert(Poly.getCoeffs().size() <= N && "Degree must be below N");
+    for (std::size_t I = 0; I < Poly.getCoeffs().size(); I++)
+      Coeffs[I] = Poly.getCoeffs()[I];
+  }
+
+  Polynom<FieldT> toPolynom(const FieldT *Field) const {
+    return Polynom<FieldT>(Field,
+                           std::vector<CoeffT>(Coeffs.begin(), Coeffs.end()));
+  }
+
+  const std::array<CoeffT, N> &getCoeffs() const { return Coeffs; }
+
+  CoeffT getCoeffAt(std::size_t CoeffDeg) const {
+    assert(CoeffDeg < N && "Out of range");
+    return Coeffs[CoeffDeg];
+  }
+
+  void setCoeffAt(std::size_t CoeffDeg, CoeffT C) {
+    assert(CoeffDeg < N && "Out of range");
+    Coeffs[CoeffDeg] = C;
+  }
+
+  std::optional<std::size_t> getDegree() const {
+    for (std::size_t I = N; I-- > 0;)
+      if (Coeffs[I] != CoeffT(0))
+        return I;
+    return std::nullopt;
+  }
+
+  bool isZero() const { return !getDegree().has_value(); }
+
+  bool isCoeff(CoeffT C) const {
+    for (std::size_t I = 1; I < N; I++)
+      if (Coeffs[I] != CoeffT(0))
+        return false;
+    return Coeffs[0] == C;
+  }
+
+  FixedPolynom &sumInPlace(const FixedPolynom &Other) {
+    for (std::size_t I = 0; I < N; I++)
+      Coeffs[I].sumInPlace(Other.Coeffs[I]);
+    return *this;
+  }
+
+  FixedPolynom sum(const FixedPolynom &Other) const {
+    FixedPolynom Res(*this);
+    return Res.sumInPlace(Other);
+  }
+
+  FixedPolynom &subInPlace(const FixedPolynom &Other) {
+    for (std::size_t I = 0; I < N; I++)
+      Coeffs[I].sumInPlace(Other.Coeffs[I].inverseSum());
+    return *this;
+  }
+
+  FixedPolynom sub(const FixedPolynom &Other) const {
+    FixedPolynom Res(*this);
+    return Res.subInPlace(Other);
+  }
+
+  FixedPolynom &mulInPlace(CoeffT Factor) {
+    for (std::size_t I = 0; I < N; I++)
+      Coeffs[I].mulInPlace(Factor);
+    return *this;
+  }
+
+  FixedPolynom mul(CoeffT Factor) const {
+    FixedPolynom Res(*this);
+    return Res.mulInPlace(Factor);
+  }
+
+  FixedPolynom inverseSum() const {
+    FixedPolynom Res;
+    return Res.subInPlace(*this);
+  }
+
+  FixedPolynom operator+(const FixedPolynom &Other) const {
+    return sum(Other);
+  }
+  FixedPolynom &operator+=(const FixedPolynom &Other) {
+    return sumInPlace(Other);
+  }
+  FixedPolynom operator-(const FixedPolynom &Other) const {
+    return sub(Other);
+  }
+  FixedPolynom &operator-=(const FixedPolynom &Other) {
+    return subInPlace(Other);
+  }
+  FixedPolynom operator-() const { return inverseSum(); }
+  FixedPolynom operator*(CoeffT Factor) const { return mul(Factor); }
+  FixedPolynom &operator*=(CoeffT Factor) { return mulInPlace(Factor); }
+
+  bool operator==(const FixedPolynom &Other) const {
+    for (std::size_t I = 0; I < N; I++)
+      if (Coeffs[I] != Other.Coeffs[I])
+        return false;
+    return true;
+  }
+  bool operator!=(const FixedPolynom &Other) const {
+    return !(*this == Other);
+  }
+
+  void print(std::ostream &OS, char Letter = 'x') const {
+    FieldT Field;
+    toPolynom(&Field).print(OS, Letter);
+  }
+
+  void printVector(std::ostream &OS, std::size_t MaxDeg = N) const {
+    for (std::size_t I = 0; I < MaxDeg; I++)
+      OS << (I < N ? Coeffs[I] : CoeffT(0));
+    OS << "\n";
+  }
+
+private:
+  std::array<CoeffT, N> Coeffs;
+};
+
+} // namespace mmath
@@ -0,0 +1,162 @@
+#pragma once
+#include <NumberTheory.hpp>
+#include <Polynom.hpp>
+#include <Stats.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Irreducibility tests and generation of irreducible polynoms. The functions
+// take the extension field (BasicFiniteField or BinaryFiniteField) and test
+// its current f(x), so all arithmetic goes through the field's own reduction.
+
+namespace mmath {
+namespace field {
+
+// Euclid's algorithm. The result is not normalized to be monic.
+template <class PolyT> PolyT PolyGcd(PolyT A, PolyT B) {
+  while (!B.isZero()) {
+    PolyT Rem(A);
+    Rem.clear();
+    A.div(B, Rem);
+    A = std::move(B);
+    B = std::move(Rem);
+  }
+  return A;
+}
+
+// Polynoms over F_p have a half-GCD based gcd of their own.
+template <class FieldT>
+Polynom<FieldT> PolyGcd(Polynom<FieldT> A, Polynom<FieldT> B) {
+  return A.gcd(B);
+}
+
+namespace detail {
+template <class ExtFieldT>
+typename ExtFieldT::ElementType MakePoly(const ExtFieldT &F,
+                                         const std::vector<std::uint64_t> &C) {
+  auto *PF = F.getPrimeField();
+  std::vector<typename ExtFieldT::ElementType::CoeffT> Coeffs;
+  Coeffs.reserve(C.size());
+  for (auto V : C)
+    Coeffs.push_back(PF->getValue(V));
+  return typename ExtFieldT::ElementType(PF, Coeffs);
+}
+
+// Whether gcd(H - x, f) has positive degree.
+template <class ExtFieldT>
+bool HasCommonFactor(const ExtFieldT &F,
+                     const typename ExtFieldT::ElementType &H) {
+  auto P = F.getPrimeField()->getOrder();
+  auto Diff = H.sum(MakePoly(F, {0, P - 1}));
+  if (Diff.isZero())
+    return true;
+  return PolyGcd(F.getIrredPoly(), Diff).getDegree().value_or(0) > 0;
+}
+} // namespace detail
+
+// Rabin's test: f of degree m is irreducible iff x^(p^m) = x mod f and
+// gcd(x^(p^(m/q)) - x, f) = 1 for every prime q dividing m.
+template <class ExtFieldT> bool IsIrreducible(const ExtFieldT &F) {
+  const auto &Irred = F.getIrredPoly();
+  auto Deg = Irred.getDegree();
+  if (!Deg || *Deg == 0)
+    return false;
+  std::size_t M = *Deg;
+  auto P = F.getPrimeField()->getOrder();
+
+  std::vector<std::size_t> Checkpoints;
+  for (auto Q : Factorize(M))
+    Checkpoints.push_back(M / Q);
+
+  auto H = F.reduce(detail::MakePoly(F, {0, 1}));
+  for (std::size_t K = 1; K <= M; K++) {
+    H = F.powMod(H, P);
+    for (auto C : Checkpoints)
+      if (C == K && detail::HasCommonFactor(F, H))
+        return false;
+  }
+  return F.reduce(H.sum(detail::MakePoly(F, {0, P - 1}))).isZero();
+}
+
+// Ben-Or's test: f is irreducible iff gcd(x^(p^i) - x, f) = 1 for all
+// i <= m / 2. It exits at the degree of the smallest factor of f, which makes
+// it faster than Rabin's test at rejecting random candidates.
+template <class ExtFieldT> bool IsIrreducibleBenOr(const ExtFieldT &F) {
+  auto Deg = F.getIrredPoly().getDegree();
+  if (!Deg || *Deg == 0)
+    return false;
+  auto P = F.getPrimeField()->getOrder();
+  auto H = F.reduce(detail::MakePoly(F, {0, 1}));
+  for (std::size_t I = 1; I <= *Deg / 2; I++) {
+    H = F.powMod(H, P);
+    if (detail::HasCommonFactor(F, H))
+      return false;
+  }
+  return true;
+}
+
+// Finds a monic irreducible polynom of degree m, installs it as f(x) in F and
+// returns it. Candidates are tried from sparsest to densest: binomials and
+// trinomials x^m + a x^k + b with small coefficients, then pentanomials
+// x^m + x^k3 + x^k2 + x^k1 + b, then random polynoms from a fixed seed. Within
+// each shape low middle degrees come first, since they reduce fastest. With
+// Primitive set, additionally requires x to generate the multiplicative group.
+template <class ExtFieldT>
+typename ExtFieldT::ElementType FindIrredPoly(ExtFieldT &F, std::size_t M,
+                                              bool Primitive = false) {
+  assert(M >= 1 && "Extension degree must be positive");
+  stats::ScopedTimer Timer(stats::Timer::IrredSearch);
+  auto P = F.getPrimeField()->getOrder();
+  auto X = detail::MakePoly(F, {0, 1});
+  auto Accept = [&](const std::vector<std::uint64_t> &Coeffs) {
+    F.setIrredPoly(detail::MakePoly(F, Coeffs));
+    return IsIrreducibleBenOr(F) && (!Primitive || F.isPrimitive(X));
+  };
+
+  std::vector<std::uint64_t> Small;
+  for (std::uint64_t V = 1; V < P && V <= 4; V++)
+    Small.push_back(V);
+  if (P - 1 > 4)
+    Small.push_back(P - 1);
+
+  std::vector<std::uint64_t> Coeffs(M + 1, 0);
+  Coeffs[M] = 1;
+  for (auto B : Small) {
+    Coeffs[0] = B;
+    if (Accept(Coeffs))
+      return F.getIrredPoly();
+  }
+  for (std::size_t K = 1; K < M; K++)
+    for (auto A : Small)
+      for (auto B : Small) {
+        Coeffs[K] = A;
+        Coeffs[0] = B;
+        if (Accept(Coeffs))
+          return F.getIrredPoly();
+        Coeffs[K] = 0;
+      }
+  for (std::size_t K3 = 3; K3 < M; K3++)
+    for (std::size_t K2 = 2; K2 < K3; K2++)
+      for (std::size_t K1 = 1; K1 < K2; K1++)
+        for (auto B : Small) {
+          Coeffs[K3] = Coeffs[K2] = Coeffs[K1] = 1;
+          Coeffs[0] = B;
+          if (Accept(Coeffs))
+            return F.getIrredPoly();
+          Coeffs[K3] = Coeffs[K2] = Coeffs[K1] = 0;
+        }
+
+  std::mt19937_64 Rng(P * 31 + M);
+  while (true) {
+    for (std::size_t I = 0; I < M; I++)
+      Coeffs[I] = Rng() % P;
+    if (Coeffs[0] != 0 && Accept(Coeffs))
+      return F.getIrredPoly();
+  }
+}
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,317 @@
+#pragma once
+#include <ModReducer.hpp>
+#include <ParallelSearch.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mmath {
+namespace field {
+
+// Dense matrix over F_p stored row-major as raw canonical residues. FieldT is
+// PrimeField or StaticPrimeField<P>; only its order is used, so entries never
+// become PrimeFieldElement objects.
+template <class FieldT> class Matrix {
+public:
+  // Pivots gathered before the pending updates are applied to the other rows.
+  static constexpr std::size_t BlockSize = 32;
+  // Columns updated together, sized so BlockSize pivot row tiles fit in L2.
+  static constexpr std::size_t TileCols = 512;
+  // Below this many entries elimination stays on the calling thread.
+  static constexpr std::size_t MinParallelEntries = 1 << 16;
+
+  Matrix(const FieldT *Field, std::size_t Rows, std::size_t Cols)
+      : Field(Field), R(Field->getOrder()), Rows(Rows), Cols(Cols),
+        Data(Rows * Cols, 0) {}
+
+  static Matrix identity(const FieldT *Field, std::size_t N) {
+    Matrix Res(Field, N, N);
+    for (std::size_t I = 0; I < N; I++)
+      Res.at(I, I) = 1;
+    return Res;
+  }
+
+  std::size_t getRows() const { return Rows; }
+  std::size_t getCols() const { return Cols; }
+  const FieldT *getField() const { return Field; }
+
+  std::uint64_t &at(std::size_t Row, std::size_t Col) {
+    assert(Row < Rows && Col < Cols);
+    return Data[Row * Cols + Col];
+  }
+
+  std::uint64_t at(std::size_t Row, std::size_t Col) const {
+    assert(Row < Rows && Col < Cols);
+    return Data[Row * Cols + Col];
+  }
+
+  std::uint64_t *row(std::size_t Row) { return Data.data() + Row * Cols; }
+  const std::uint64_t *row(std::size_t Row) const {
+    return Data.data() + Row * Cols;
+  }
+
+  bool operator==(const Matrix &Other) const {
+    return Rows == Other.Rows && Cols == Other.Cols && Data == Other.Data;
+  }
+
+  Matrix mul(const Matrix &Other, unsigned NumThreads = 1) const {
+    assert(Cols == Other.Rows && "Dimension mismatch");
+    Matrix Res(Field, Rows, Other.Cols);
+    ParallelFor(Rows, threadsFor(Rows * Other.Cols, NumThreads),
+                [&](std::size_t Begin, std::size_t End) {
+                  std::vector<std::uint64_t> Coeffs(Cols);
+                  for (std::size_t I = Begin; I < End; I++) {
+                    // Res_I = sum_K A_IK * B_K is a row update with the
+                    // negated coefficients.
+                    for (std::size_t K = 0; K < Cols; K++)
+                      Coeffs[K] = R.neg(at(I, K));
+                    Res.subtractCombination(Res.row(I), Coeffs.data(), Other,
+                                            0, Cols, 0);
+                  }
+                });
+    return Res;
+  }
+
+  // Brings the matrix to reduced row echelon form and returns the pivot
+  // columns, so the rank is their count.
+  //
+  // Gauss-Jordan elimination that gathers up to BlockSize pivots before
+  // touching the other rows. A row's pending value in column C is
+  // row[C] - sum_K row[col_K] * pivot_K[C] over the gathered pivots, which
+  // are kept mutually reduced. Only the pivot search and each new pivot row
+  // apply it eagerly. The remaining rows get the whole block at once in column
+  // tiles, with products summed before a single reduction, and are split
+  // across NumThreads threads.
+  std::vector<std::size_t> reducedRowEchelonInPlace(unsigned NumThreads = 1) {
+    std::vector<std::size_t> Pivots;
+    std::size_t BlockBegin = 0;
+    for (std::size_t Col = 0; Col < Cols && Pivots.size() < Rows; Col++) {
+      auto Rank = Pivots.size();
+      std::size_t PivotRow = Rows;
+      std::uint64_t PivotVal = 0;
+      for (std::size_t I = Rank; I < Rows && PivotRow == Rows; I++) {
+        PivotVal = pendingValue(I, Col, BlockBegin, Pivots);
+        if (PivotVal != 0)
+          PivotRow = I;
+      }
+      if (PivotRow == Rows)
+        continue;
+
+      swapRows(PivotRow, Rank);
+      auto *Piv = row(Rank);
+      applyBlock(Piv, BlockBegin, Pivots);
+      auto Inv = R.inv(PivotVal);
+      for (std::size_t J = Col; J < Cols; J++)
+        Piv[J] = R.mul(Piv[J], Inv);
+      for (auto K = BlockBegin; K < Rank; K++) {
+        auto *Other = row(K);
+        if (auto F = Other[Col])
+          for (std::size_t J = Col; J < Cols; J++)
+            Other[J] = R.sub(Other[J], R.mul(F, Piv[J]));
+      }
+      Pivots.push_back(Col);
+
+      if (Pivots.size() - BlockBegin == BlockSize) {
+        flushBlock(BlockBegin, Pivots, NumThreads);
+        BlockBegin = Pivots.size();
+      }
+    }
+    flushBlock(BlockBegin, Pivots, NumThreads);
+    return Pivots;
+  }
+
+  std::size_t rank(unsigned NumThreads = 1) const {
+    Matrix Copy(*this);
+    return Copy.reducedRowEchelonInPlace(NumThreads).size();
+  }
+
+  // Returns X with this * X = B, or nothing if the system is inconsistent.
+  // Free variables are set to zero.
+  std::optional<std::vector<std::uint64_t>>
+  solve(const std::vector<std::uint64_t> &B, unsigned NumThreads = 1) const {
+    assert(B.size() == Rows && "Dimension mismatch");
+    Matrix Aug(Field, Rows, Cols + 1);
+    for (std::size_t I = 0; I < Rows; I++) {
+      std::copy(row(I), row(I) + Cols, Aug.row(I));
+      Aug.at(I, Cols) = B[I];
+    }
+    auto Pivots = Aug.reducedRowEchelonInPlace(NumThreads);
+    if (!Pivots.empty() && Pivots.back() == Cols)
+      return std::nullopt;
+    std::vector<std::uint64_t> X(Cols, 0);
+    for (std::size_t K = 0; K < Pivots.size(); K++)
+      X[Pivots[K]] = Aug.at(K, Cols);
+    return X;
+  }
+
+  // Returns a matrix whose rows form a basis of {X : this * X = 0}.
+  Matrix nullspace(unsigned NumThreads = 1) const {
+    Matrix Ech(*this);
+    auto Pivots = Ech.reducedRowEchelonInPlace(NumThreads);
+    std::vector<bool> IsPivot(Cols, false);
+    for (auto C : Pivots)
+      IsPivot[C] = true;
+    Matrix Basis(Field, Cols - Pivots.size(), Cols);
+    std::size_t Next = 0;
+    for (std::size_t Free = 0; Free < Cols; Free++) {
+      if (IsPivot[Free])
+        continue;
+      Basis.at(Next, Free) = 1;
+      for (std::size_t K = 0; K < Pivots.size(); K++)
+        Basis.at(Next, Pivots[K]) = R.neg(Ech.at(K, Free));
+      Next++;
+    }
+    return Basis;
+  }
+
+  // Returns the inverse of a square matrix, or nothing if it is singular.
+  std::optional<Matrix> inverse(unsigned NumThreads = 1) const {
+    assert(Rows == Cols && "Matrix must be square");
+    if (Rows == 0)
+      return *this;
+    Matrix Aug(Field, Rows, 2 * Cols);
+    for (std::size_t I = 0; I < Rows; I++) {
+      std::copy(row(I), row(I) + Cols, Aug.row(I));
+      Aug.at(I, Cols + I) = 1;
+    }
+    auto Pivots = Aug.reducedRowEchelonInPlace(NumThreads);
+    if (Pivots.size() < Rows || Pivots.back() >= Cols)
+      return std::nullopt;
+    Matrix Inv(Field, Rows, Cols);
+    for (std::size_t I = 0; I < Rows; I++)
+      std::copy(Aug.row(I) + Cols, Aug.row(I) + 2 * Cols, Inv.row(I));
+    return Inv;
+  }
+
+private:
+  const FieldT *Field;
+  ModReducer R;
+  std::size_t Rows;
+  std::size_t Cols;
+  std::vector<std::uint64_t> Data;
+
+  static unsigned threadsFor(std::size_t Entries, unsigned NumThreads) {
+    return Entries < MinParallelEntries ? 1 : NumThreads;
+  }
+
+  void swapRows(std::size_t A, std::size_t B) {
+    if (A != B)
+      std::swap_ranges(row(A), row(A) + Cols, row(B));
+  }
+
+  std::uint64_t pendingValue(std::size_t Row, std::size_t Col,
+                             std::size_t BlockBegin,
+                             const std::vector<std::size_t> &Pivots) const {
+    auto Val = at(Row, Col);
+    for (auto K = BlockBegin; K < Pivots.size(); K++)
+      if (auto F = at(Row, Pivots[K]))
+        Val = R.sub(Val, R.mul(F, at(K, Col)));
+    return Val;
+  }
+
+  // Applies the gathered pivots to Target. Pivot rows are zero left of the
+  // first pivot column of their block, so earlier columns are skipped.
+  void applyBlock(std::uint64_t *Target, std::size_t BlockBegin,
+                  const std::vector<std::size_t> &Pivots) const {
+    auto Count = Pivots.size() - BlockBegin;
+    if (Count == 0)
+      return;
+    std::vector<std::uint64_t> Coeffs(Count);
+    for (std::size_t K = 0; K < Count; K++)
+      Coeffs[K] = Target[Pivots[BlockBegin + K]];
+    subtractCombination(Target, Coeffs.data(), *this, BlockBegin, Count,
+                        Pivots[BlockBegin]);
+  }
+
+  // Target[J] -= sum_K Coeffs[K] * Src.row(SrcBegin + K)[J] for
+  // J >= FromCol. Target may be one of the source rows only if its own
+  // coefficient is zero.
+  void subtractCombination(std::uint64_t *Target, const std::uint64_t *Coeffs,
+                           const Matrix &Src, std::size_t SrcBegin,
+                           std::size_t Count, std::size_t FromCol) const {
+    auto N = R.getModulus();
+    std::vector<std::uint64_t> Neg;
+    Neg.reserve(Count);
+    std::vector<const std::uint64_t *> SrcRows;
+    SrcRows.reserve(Count);
+    for (std::size_t K = 0; K < Count; K++)
+      if (Coeffs[K] != 0) {
+        Neg.push_back(N - Coeffs[K]);
+        SrcRows.push_back(Src.row(SrcBegin + K));
+      }
+    if (Neg.empty())
+      return;
+
+    // Delayed reduction: a residue plus Chunk products of two residues fits in
+    // 64 bits, so each accumulator is reduced once per Chunk source rows.
+    // Larger moduli sum 128-bit products and stay below N * 2^64, the bound
+    // of ModReducer::reduceWide.
+    if (N < (std::uint64_t(1) << 32)) {
+      auto Chunk = (UINT64_MAX - N) / ((N - 1) * (N - 1));
+      accumulateRows<std::uint64_t>(Target, Neg, SrcRows, FromCol, Src.Cols,
+                                    Chunk);
+      return;
+    }
+    auto Chunk = static_cast<std::uint64_t>(((uint128_t(N) << 64) - N) /
+                                            (uint128_t(N - 1) * (N - 1)));
+    accumulateRows<uint128_t>(Target, Neg, SrcRows, FromCol, Src.Cols, Chunk);
+  }
+
+  // The tiled loop of subtractCombination, with sums of AccT reduced every
+  // Chunk source rows.
+  template <class AccT>
+  void accumulateRows(std::uint64_t *Target,
+                      const std::vector<std::uint64_t> &Neg,
+                      const std::vector<const std::uint64_t *> &SrcRows,
+                      std::size_t FromCol, std::size_t Cols,
+                      std::uint64_t Chunk) const {
+    AccT Acc[TileCols];
+    for (auto Tile = FromCol; Tile < Cols; Tile += TileCols) {
+      auto Width = std::min(TileCols, Cols - Tile);
+      for (std::size_t J = 0; J < Width; J++)
+        Acc[J] = Target[Tile + J];
+      for (std::size_t K = 0; K < Neg.size();) {
+        auto End = K + std::min<std::uint64_t>(Chunk, Neg.size() - K);
+        for (; K < End; K++) {
+          AccT F = Neg[K];
+          const auto *S = SrcRows[K] + Tile;
+          for (std::size_t J = 0; J < Width; J++)
+            Acc[J] += F * S[J];
+        }
+        for (std::size_t J = 0; J < Width; J++) {
+          if constexpr (std::is_same<AccT, std::uint64_t>::value)
+            Acc[J] = R.reduce(Acc[J]);
+          else
+            Acc[J] = R.reduceWide(Acc[J]);
+        }
+      }
+      std::copy(Acc, Acc + Width, Target + Tile);
+    }
+  }
+
+  // Applies the gathered block to every row outside it.
+  void flushBlock(std::size_t BlockBegin,
+                  const std::vector<std::size_t> &Pivots,
+                  unsigned NumThreads) {
+    auto BlockEnd = Pivots.size();
+    if (BlockEnd == BlockBegin)
+      return;
+    auto Others = Rows - (BlockEnd - BlockBegin);
+    auto Width = Cols - Pivots[BlockBegin];
+    ParallelFor(Others, threadsFor(Others * Width, NumThreads),
+                [&](std::size_t Begin, std::size_t End) {
+                  for (auto I = Begin; I < End; I++) {
+                    auto Row = I < BlockBegin ? I : I + BlockEnd - BlockBegin;
+                    applyBlock(row(Row), BlockBegin, Pivots);
+                  }
+                });
+  }
+};
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,184 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+namespace mmath {
+namespace field {
+
+using uint128_t = unsigned __int128;
+
+// Division-free arithmetic on residues modulo N < 2^63. All arguments and
+// results are canonical residues in [0, N). The reduction strategy is picked
+// from the modulus size:
+//  - Barrett with a 64-bit reciprocal when N < 2^32, so a product of two
+//    residues fits in 64 bits;
+//  - Montgomery with R = 2^64 for larger odd N, using 128-bit products;
+//  - plain 128-bit remainder for larger even N (never a prime).
+class ModReducer {
+public:
+  enum class Kind { Barrett, Montgomery, Generic };
+
+private:
+  std::uint64_t N = 1;
+  Kind K = Kind::Barrett;
+  // floor((2^64 - 1) / N).
+  std::uint64_t BarrettR = 0;
+  // -N^-1 mod 2^64.
+  std::uint64_t MontNInv = 0;
+  // 2^128 mod N, converts a Montgomery product back to a plain one.
+  std::uint64_t MontR2 = 0;
+
+  static constexpr std::uint64_t mulHi(std::uint64_t A, std::uint64_t B) {
+    return static_cast<std::uint64_t>((uint128_t(A) * B) >> 64);
+  }
+
+  // Returns T * 2^-64 mod N for T < N * 2^64.
+  constexpr std::uint64_t redc(uint128_t T) const {
+    std::uint64_t Q = static_cast<std::uint64_t>(T) * MontNInv;
+    auto Res = static_cast<std::uint64_t>((T + uint128_t(Q) * N) >> 64);
+    return Res >= N ? Res - N : Res;
+  }
+
+  constexpr std::uint64_t barrettReduce(std::uint64_t X) const {
+    std::uint64_t Res = X - mulHi(X, BarrettR) * N;
+    // The quotient estimate is at most 2 too small.
+    if (Res >= N)
+      Res -= N;
+    if (Res >= N)
+      Res -= N;
+    return Res;
+  }
+
+  std::uint64_t invEuclid(std::uint64_t A) const {
+    std::int64_t OldR = static_cast<std::int64_t>(N);
+    std::int64_t R = static_cast<std::int64_t>(A);
+    std::int64_t OldS = 0, S = 1;
+    while (R != 0) {
+      auto Q = OldR / R;
+      std::tie(OldR, R) = std::make_pair(R, OldR - Q * R);
+      std::tie(OldS, S) = std::make_pair(S, OldS - Q * S);
+    }
+    assert(OldR == 1 && "Value is not invertible");
+    return OldS < 0 ? static_cast<std::uint64_t>(OldS + std::int64_t(N))
+                    : static_cast<std::uint64_t>(OldS);
+  }
+
+public:
+  constexpr ModReducer() = default;
+
+  constexpr explicit ModReducer(std::uint64_t N) : N(N) {
+    assert(N != 0 && N < (std::uint64_t(1) << 63) &&
+           "Modulus must be in [1, 2^63)");
+    if (N < (std::uint64_t(1) << 32)) {
+      K = Kind::Barrett;
+      BarrettR = UINT64_MAX / N;
+      return;
+    }
+    if (N % 2 == 0) {
+      K = Kind::Generic;
+      return;
+    }
+    K = Kind::Montgomery;
+    // Newton iteration doubles the number of correct low bits each step,
+    // starting from 3 correct bits since N * N == 1 mod 8 for odd N.
+    std::uint64_t Inv = N;
+    for (int I = 0; I < 5; I++)
+      Inv *= 2 - N * Inv;
+    MontNInv = -Inv;
+    auto R = static_cast<std::uint64_t>((uint128_t(1) << 64) % N);
+    MontR2 = static_cast<std::uint64_t>(uint128_t(R) * R % N);
+  }
+
+  constexpr std::uint64_t getModulus() const { return N; }
+
+  constexpr Kind getKind() const { return K; }
+
+  // Reduces an arbitrary 64-bit value.
+  constexpr std::uint64_t reduce(std::uint64_t X) const {
+    if (K == Kind::Barrett)
+      return barrettReduce(X);
+    return X % N;
+  }
+
+  // Reduces T < N * 2^64, such as a residue plus 2^64 / N - 1 products of
+  // two residues.
+  constexpr std::uint64_t reduceWide(uint128_t T) const {
+    if (K == Kind::Montgomery)
+      return redc(uint128_t(redc(T)) * MontR2);
+    return static_cast<std::uint64_t>(T % N);
+  }
+
+  constexpr std::uint64_t add(std::uint64_t A, std::uint64_t B) const {
+    std::uint64_t Res = A + B;
+    return Res >= N ? Res - N : Res;
+  }
+
+  constexpr std::uint64_t sub(std::uint64_t A, std::uint64_t B) const {
+    return A >= B ? A - B : A + (N - B);
+  }
+
+  constexpr std::uint64_t neg(std::uint64_t A) const {
+    return A == 0 ? 0 : N - A;
+  }
+
+  constexpr std::uint64_t pow(std::uint64_t A, std::uint64_t Exp) const {
+    std::uint64_t Res = reduce(1);
+    while (Exp) {
+      if (Exp & 1)
+        Res = mul(Res, A);
+      Exp >>= 1;
+      if (Exp)
+        A = mul(A, A);
+    }
+    return Res;
+  }
+
+  // Returns A^-1 mod N. A must be coprime with N. Odd moduli use the binary
+  // extended Euclidean algorithm, which only needs shifts and subtractions.
+  std::uint64_t inv(std::uint64_t A) const {
+    assert(A != 0 && "Zero has no inverse");
+    if (N % 2 == 0)
+      return invEuclid(A);
+    std::uint64_t U = A, V = N;
+    std::uint64_t X1 = 1, X2 = 0;
+    auto Halve = [this](std::uint64_t X) {
+      return (X % 2 == 0) ? X / 2 : X / 2 + N / 2 + 1;
+    };
+    while (U != 1 && V != 1) {
+      while (U % 2 == 0) {
+        U /= 2;
+        X1 = Halve(X1);
+      }
+      while (V % 2 == 0) {
+        V /= 2;
+        X2 = Halve(X2);
+      }
+      if (U >= V) {
+        U -= V;
+        X1 = sub(X1, X2);
+      } else {
+        V -= U;
+        X2 = sub(X2, X1);
+      }
+      assert(U != 0 && V != 0 && "Value is not invertible");
+    }
+    return U == 1 ? X1 : X2;
+  }
+
+  constexpr std::uint64_t mul(std::uint64_t A, std::uint64_t B) const {
+    switch (K) {
+    case Kind::Barrett:
+      return barrettReduce(A * B);
+    case Kind::Montgomery:
+      return redc(uint128_t(redc(uint128_t(A) * B)) * MontR2);
+    case Kind::Generic:
+      break;
+    }
+    return static_cast<std::uint64_t>(uint128_t(A) * B % N);
+  }
+};
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,97 @@
+#pragma once
+#include <ModReducer.hpp>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace mmath {
+namespace field {
+
+// Returns Base^Exp, which must fit in 64 bits.
+inline std::uint64_t IntPow(std::uint64_t Base, std::uint64_t Exp) {
+  std::uint64_t Res = 1;
+  for (std::uint64_t I = 0; I < Exp; I++) {
+    assert((Base == 0 || Res <= UINT64_MAX / Base) &&
+           "Power must fit in 64 bits");
+    Res *= Base;
+  }
+  return Res;
+}
+
+namespace detail {
+// Returns A * B mod N for any 64-bit modulus.
+constexpr std::uint64_t MulModWide(std::uint64_t A, std::uint64_t B,
+                                   std::uint64_t N) {
+  return static_cast<std::uint64_t>(uint128_t(A) * B % N);
+}
+
+// Miller-Rabin round for odd N > 2 with N - 1 = D * 2^S. Returns whether N is
+// a strong probable prime to base A.
+template <class MulFnT>
+constexpr bool IsStrongProbablePrime(std::uint64_t N, std::uint64_t D,
+                                     unsigned S, std::uint64_t A,
+                                     MulFnT Mul) {
+  A %= N;
+  if (A == 0)
+    return true;
+  std::uint64_t X = 1;
+  for (auto Base = A, Exp = D; Exp; Exp >>= 1) {
+    if (Exp & 1)
+      X = Mul(X, Base);
+    Base = Mul(Base, Base);
+  }
+  if (X == 1 || X == N - 1)
+    return true;
+  for (unsigned I = 1; I < S; I++) {
+    X = Mul(X, X);
+    if (X == N - 1)
+      return true;
+  }
+  return false;
+}
+} // namespace detail
+
+// Deterministic Miller-Rabin. The first twelve primes as bases are known to
+// give no false positives below 2^64.
+constexpr bool IsPrime(std::uint64_t N) {
+  constexpr std::uint64_t Bases[] = {2,  3,  5,  7,  11, 13,
+                                     17, 19, 23, 29, 31, 37};
+  if (N < 2)
+    return false;
+  for (auto B : Bases) {
+    if (N == B)
+      return true;
+    if (N % B == 0)
+      return false;
+  }
+  if (N < 41 * 41)
+    return true;
+  auto D = N - 1;
+  unsigned S = 0;
+  for (; D % 2 == 0; D /= 2)
+    S++;
+  if (N < (std::uint64_t(1) << 63)) {
+    ModReducer R(N);
+    auto Mul = [&R](std::uint64_t A, std::uint64_t B) { return R.mul(A, B); };
+    for (auto B : Bases)
+      if (!detail::IsStrongProbablePrime(N, D, S, B, Mul))
+        return false;
+    return true;
+  }
+  auto Mul = [N](std::uint64_t A, std::uint64_t B) {
+    return detail::MulModWide(A, B, N);
+  };
+  for (auto B : Bases)
+    if (!detail::IsStrongProbablePrime(N, D, S, B, Mul))
+      return false;
+  return true;
+}
+
+// Returns distinct prime factors of N in increasing order. Small factors are
+// found by trial division over a sieve of primes, the rest by Pollard-Brent
+// rho. Results are cached, so repeated queries for the same order are free.
+// Returns no factors for N < 2.
+std::vector<std::uint64_t> Factorize(std::uint64_t N);
+
+} // namespace field
+} // namespace mmath
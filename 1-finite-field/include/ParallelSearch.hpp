@@ -0,0 +1,71 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace mmath {
+namespace field {
+
+// Returns the smallest Index in [0, Count) for which Pred(Index) holds, or
+// Count if there is none. NumThreads workers claim chunks of ChunkSize
+// consecutive indices in increasing order and stop claiming once a match
+// below their next chunk is known, so the answer is the same as a serial scan
+// while the work after the first match stays bounded. Pred must be safe to
+// call concurrently.
+template <class PredT>
+std::uint64_t FindFirstParallel(std::uint64_t Count, unsigned NumThreads,
+                                PredT Pred, std::uint64_t ChunkSize = 8) {
+  std::atomic<std::uint64_t> NextChunk{0};
+  std::atomic<std::uint64_t> Best{Count};
+
+  auto Worker = [&]() {
+    while (true) {
+      auto Begin = NextChunk.fetch_add(ChunkSize);
+      if (Begin >= Count || Begin >= Best.load())
+        return;
+      auto End = std::min(Count - Begin, ChunkSize) + Begin;
+      for (auto Index = Begin; Index < End && Index < Best.load(); Index++) {
+        if (!Pred(Index))
+          continue;
+        auto Cur = Best.load();
+        while (Index < Cur && !Best.compare_exchange_weak(Cur, Index))
+          ;
+        return;
+      }
+    }
+  };
+
+  std::vector<std::thread> Threads;
+  Threads.reserve(NumThreads);
+  for (unsigned I = 0; I < std::max(NumThreads, 1u); I++)
+    Threads.emplace_back(Worker);
+  for (auto &T : Threads)
+    T.join();
+  return Best.load();
+}
+
+// Splits [0, Count) into NumThreads contiguous ranges and calls
+// Fn(Begin, End) for each range on its own thread. Runs inline when one thread
+// is requested.
+template <class FnT>
+void ParallelFor(std::size_t Count, unsigned NumThreads, FnT Fn) {
+  NumThreads = static_cast<unsigned>(
+      std::max<std::size_t>(1, std::min<std::size_t>(NumThreads, Count)));
+  if (NumThreads == 1) {
+    Fn(std::size_t(0), Count);
+    return;
+  }
+  std::vector<std::thread> Threads;
+  Threads.reserve(NumThreads);
+  for (unsigned I = 0; I < NumThreads; I++)
+    Threads.emplace_back(Fn, Count * I / NumThreads,
+                         Count * (I + 1) / NumThreads);
+  for (auto &T : Threads)
+    T.join();
+}
+
+} // namespace field
+} // namespace mmath
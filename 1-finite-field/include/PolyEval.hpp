@@ -0,0 +1,210 @@
+#pragma once
+#include <ModReducer.hpp>
+#include <PolyGcd.hpp>
+#include <PolyMul.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace mmath {
+namespace field {
+
+namespace detail {
+// Replaces A with A mod F for a monic F of degree d >= 1. InvRev is
+// rev(F)^-1 mod x^d, or empty to fall back to long division. With the
+// inverse, each step reduces the top 2d coefficients of A Barrett-style, as
+// in PolyReducer, and drops d of them.
+inline void ReduceMonic(const ModReducer &R, Residues &A, const Residues &F,
+                        const Residues &InvRev) {
+  auto D = F.size() - 1;
+  if (A.size() <= D)
+    return;
+  if (InvRev.empty()) {
+    for (std::size_t I = A.size() - D; I-- > 0;) {
+      auto C = A[I + D];
+      if (C == 0)
+        continue;
+      for (std::size_t J = 0; J < D; J++)
+        A[I + J] = R.sub(A[I + J], R.mul(C, F[J]));
+    }
+  } else {
+    for (auto N = A.size(); N > D;) {
+      auto Len = std::min(N, 2 * D);
+      auto Base = N - Len, K = Len - D;
+      Residues RevTop(K), InvLow(InvRev.begin(), InvRev.begin() + K);
+      for (std::size_t T = 0; T < K; T++)
+        RevTop[T] = A[N - 1 - T];
+      auto QuotRev = MulResidues(R, RevTop, InvLow);
+      Residues Q(K, 0);
+      for (std::size_t J = 0; J < K && J < QuotRev.size(); J++)
+        Q[K - 1 - J] = QuotRev[J];
+      auto QF = MulResidues(R, Q, F);
+      for (std::size_t I = 0; I < D && I < QF.size(); I++)
+        A[Base + I] = R.sub(A[Base + I], QF[I]);
+      N = Base + D;
+    }
+  }
+  A.resize(D);
+  TrimResidues(A);
+}
+} // namespace detail
+
+// Subproduct tree over distinct points a_0, ..., a_{n-1}: level 0 holds the
+// linear factors x - a_i, and every node above is the product of two
+// adjacent nodes below it (an odd one out moves up unchanged), up to
+// M(x) = (x - a_0) ... (x - a_{n-1}) at the root.
+//
+// Evaluation pushes F mod M down the tree as remainders, and interpolation
+// combines the Lagrange terms back up it. Both take O(M(n) log n) instead of
+// the O(n^2) of point-by-point methods. Build the tree once per point set
+// and reuse it across calls; it holds about (log2(n) + 2) n residues.
+class SubproductTree {
+public:
+  // Subtrees with at most this many points are evaluated by Horner's rule.
+  static constexpr std::size_t LeafPoints = 16;
+
+  SubproductTree() = default;
+
+  // Points are residues modulo the prime Modulus, or field elements
+  // convertible to them.
+  template <class PointT>
+  SubproductTree(std::uint64_t Modulus, const std::vector<PointT> &Points)
+      : R(Modulus) {
+    this->Points.reserve(Points.size());
+    for (const auto &X : Points)
+      this->Points.push_back(R.reduce(std::uint64_t(X)));
+    build();
+  }
+
+  std::uint64_t getModulus() const { return R.getModulus(); }
+  std::size_t size() const { return Points.size(); }
+  const Residues &getPoints() const { return Points; }
+
+  // M(x), monic of degree n.
+  const Residues &getRoot() const { return Levels.back()[0]; }
+
+  // F(a_i) for every point.
+  Residues evaluate(Residues F) const {
+    Residues Values(Points.size(), 0);
+    if (!Points.empty()) {
+      detail::TrimResidues(F);
+      evaluateNode(Levels.size() - 1, 0, std::move(F), Values);
+    }
+    return Values;
+  }
+
+  // The polynom of degree < n with value Values[i] at a_i, as the sum of
+  // Values[i] w_i M(x) / (x - a_i) with w_i = 1 / M'(a_i).
+  Residues interpolate(const Residues &Values) const {
+    assert(Values.size() == Points.size() && "Need one value per point");
+    if (Points.empty())
+      return {};
+    std::vector<Residues> Cur(Points.size());
+    for (std::size_t I = 0; I < Points.size(); I++)
+      if (auto C = R.mul(R.reduce(Values[I]), Weights[I]))
+        Cur[I] = {C};
+    for (std::size_t L = 1; L < Levels.size(); L++) {
+      const auto &Below = Levels[L - 1];
+      std::vector<Residues> Next(Levels[L].size());
+      for (std::size_t J = 0; J < Next.size(); J++) {
+        if (2 * J + 1 == Below.size())
+          Next[J] = std::move(Cur[2 * J]);
+        else
+          Next[J] = detail::MulAdd(R, Cur[2 * J], Below[2 * J + 1],
+                                   Cur[2 * J + 1], Below[2 * J]);
+      }
+      Cur = std::move(Next);
+    }
+    return std::move(Cur[0]);
+  }
+
+private:
+  ModReducer R;
+  Residues Points;
+  // Levels[L][J] covers the points [J 2^L, (J + 1) 2^L).
+  std::vector<std::vector<Residues>> Levels;
+  // rev(Levels[L][J])^-1 mod x^deg, for nodes long enough to use it.
+  std::vector<std::vector<Residues>> InvRevs;
+  // 1 / M'(a_i).
+  Residues Weights;
+
+  void build() {
+    if (Points.empty())
+      return;
+    Levels.emplace_back();
+    for (auto X : Points)
+      Levels.back().push_back({R.neg(X), R.reduce(1)});
+    while (Levels.back().size() > 1) {
+      const auto &Below = Levels.back();
+      std::vector<Residues> Next;
+      Next.reserve((Below.size() + 1) / 2);
+      for (std::size_t J = 0; J < Below.size(); J += 2)
+        Next.push_back(J + 1 < Below.size()
+                           ? MulResidues(R, Below[J], Below[J + 1])
+                           : Below[J]);
+      Levels.push_back(std::move(Next));
+    }
+
+    InvRevs.resize(Levels.size());
+    for (std::size_t L = 0; L < Levels.size(); L++) {
+      InvRevs[L].resize(Levels[L].size());
+      for (std::size_t J = 0; J < Levels[L].size(); J++) {
+        const auto &Node = Levels[L][J];
+        auto D = Node.size() - 1;
+        if (D < PolyMulThresholds.Karatsuba)
+          continue;
+        InvRevs[L][J] =
+            InvSeries(R, Residues(Node.rbegin(), Node.rend()), D);
+      }
+    }
+
+    const auto &Root = getRoot();
+    Residues Derivative(Root.size() - 1);
+    for (std::size_t I = 1; I < Root.size(); I++)
+      Derivative[I - 1] = R.mul(Root[I], R.reduce(I));
+    Weights = evaluate(std::move(Derivative));
+    invertAll(Weights);
+  }
+
+  // Montgomery's trick: one inversion and 3(n - 1) multiplications.
+  void invertAll(Residues &Values) const {
+    Residues Prefix(Values.size());
+    std::uint64_t Acc = R.reduce(1);
+    for (std::size_t I = 0; I < Values.size(); I++) {
+      assert(Values[I] != 0 && "Points must be distinct");
+      Prefix[I] = Acc;
+      Acc = R.mul(Acc, Values[I]);
+    }
+    Acc = R.inv(Acc);
+    for (std::size_t I = Values.size(); I-- > 0;) {
+      auto Inv = R.mul(Acc, Prefix[I]);
+      Acc = R.mul(Acc, Values[I]);
+      Values[I] = Inv;
+    }
+  }
+
+  void evaluateNode(std::size_t L, std::size_t J, Residues Rem,
+                    Residues &Values) const {
+    detail::ReduceMonic(R, Rem, Levels[L][J], InvRevs[L][J]);
+    auto Begin = J << L;
+    auto End = std::min(Begin + (std::size_t(1) << L), Points.size());
+    if (End - Begin <= LeafPoints) {
+      for (auto I = Begin; I < End; I++) {
+        std::uint64_t Sum = 0;
+        for (std::size_t K = Rem.size(); K-- > 0;)
+          Sum = R.add(R.mul(Sum, Points[I]), Rem[K]);
+        Values[I] = Sum;
+      }
+      return;
+    }
+    if (2 * J + 1 < Levels[L - 1].size())
+      evaluateNode(L - 1, 2 * J + 1, Rem, Values);
+    evaluateNode(L - 1, 2 * J, std::move(Rem), Values);
+  }
+};
+
+} // namespace field
+} // namespace mmath
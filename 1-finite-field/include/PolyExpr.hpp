@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+// Lazy coefficient-wise polynom expressions. Sums, differences, negation,
+// scaling by a field element and shifts by x^k build small expression
+// objects instead of polynoms; assigning one to a Polynom computes every
+// coefficient in a single pass into the destination's storage. Products of
+// two polynoms are not coefficient-wise and stay eager.
+//
+// Expressions refer to their Polynom operands, so evaluate them in the
+// statement that builds them rather than keeping them in variables.
+
+namespace mmath {
+template <class FieldT> class Polynom;
+
+namespace expr {
+template <class ExprT> class Shifted;
+
+// Polynom operands are held by reference, nested expressions by value.
+template <class T> struct OperandOf {
+  using Type = T;
+};
+template <class FieldT> struct OperandOf<Polynom<FieldT>> {
+  using Type = const Polynom<FieldT> &;
+};
+template <class T> using OperandT = typename OperandOf<T>::Type;
+
+// CRTP base of all expressions, Polynom included. DerivedT provides
+//   const FieldType *getField() const;
+//   std::size_t size() const;            // all coefficients from here are 0
+//   CoeffT coeffAt(std::size_t I) const; // for any I
+template <class DerivedT> struct PolyExpr {
+  const DerivedT &self() const { return static_cast<const DerivedT &>(*this); }
+
+  // Multiplies by x^K.
+  Shifted<DerivedT> shift(std::size_t K) const {
+    return Shifted<DerivedT>(self(), K);
+  }
+};
+
+template <class LhsT, class RhsT, bool Negate>
+class AddSub : public PolyExpr<AddSub<LhsT, RhsT, Negate>> {
+public:
+  using FieldType = typename LhsT::FieldType;
+  using CoeffT = typename LhsT::CoeffT;
+
+  AddSub(const LhsT &Lhs, const RhsT &Rhs) : Lhs(Lhs), Rhs(Rhs) {}
+
+  const FieldType *getField() const { return Lhs.getField(); }
+  std::size_t size() const { return std::max(Lhs.size(), Rhs.size()); }
+  CoeffT coeffAt(std::size_t I) const {
+    if constexpr (Negate)
+      return Lhs.coeffAt(I) + Rhs.coeffAt(I).inverseSum();
+    else
+      return Lhs.coeffAt(I) + Rhs.coeffAt(I);
+  }
+
+private:
+  OperandT<LhsT> Lhs;
+  OperandT<RhsT> Rhs;
+};
+
+template <class ExprT> class Scaled : public PolyExpr<Scaled<ExprT>> {
+public:
+  using FieldType = typename ExprT::FieldType;
+  using CoeffT = typename ExprT::CoeffT;
+
+  Scaled(const ExprT &Expr, CoeffT Factor) : Expr(Expr), Factor(Factor) {}
+
+  const FieldType *getField() const { return Expr.getField(); }
+  std::size_t size() const {
+    return Factor == getField()->zero() ? 0 : Expr.size();
+  }
+  CoeffT coeffAt(std::size_t I) const { return Expr.coeffAt(I) * Factor; }
+
+private:
+  OperandT<ExprT> Expr;
+  CoeffT Factor;
+};
+
+template <class ExprT> class Negated : public PolyExpr<Negated<ExprT>> {
+public:
+  using FieldType = typename ExprT::FieldType;
+  using CoeffT = typename ExprT::CoeffT;
+
+  explicit Negated(const ExprT &Expr) : Expr(Expr) {}
+
+  const FieldType *getField() const { return Expr.getField(); }
+  std::size_t size() const { return Expr.size(); }
+  CoeffT coeffAt(std::size_t I) const { return Expr.coeffAt(I).inverseSum(); }
+
+private:
+  OperandT<ExprT> Expr;
+};
+
+template <class ExprT> class Shifted : public PolyExpr<Shifted<ExprT>> {
+public:
+  using FieldType = typename ExprT::FieldType;
+  using CoeffT = typename ExprT::CoeffT;
+
+  Shifted(const ExprT &Expr, std::size_t Shift) : Expr(Expr), Shift(Shift) {}
+
+  const FieldType *getField() const { return Expr.getField(); }
+  std::size_t size() const {
+    auto Size = Expr.size();
+    return Size ? Size + Shift : 0;
+  }
+  CoeffT coeffAt(std::size_t I) const {
+    return I < Shift ? getField()->zero() : Expr.coeffAt(I - Shift);
+  }
+
+private:
+  OperandT<ExprT> Expr;
+  std::size_t Shift;
+};
+
+template <class LhsT, class RhsT>
+AddSub<LhsT, RhsT, false> operator+(const PolyExpr<LhsT> &Lhs,
+                                    const PolyExpr<RhsT> &Rhs) {
+  return {Lhs.self(), Rhs.self()};
+}
+
+template <class LhsT, class RhsT>
+AddSub<LhsT, RhsT, true> operator-(const PolyExpr<LhsT> &Lhs,
+                                   const PolyExpr<RhsT> &Rhs) {
+  return {Lhs.self(), Rhs.self()};
+}
+
+template <class ExprT> Negated<ExprT> operator-(const PolyExpr<ExprT> &Expr) {
+  return Negated<ExprT>(Expr.self());
+}
+
+template <class ExprT>
+Scaled<ExprT> operator*(const PolyExpr<ExprT> &Expr,
+                        typename ExprT::CoeffT Factor) {
+  return {Expr.self(), Factor};
+}
+
+template <class ExprT>
+Scaled<ExprT> operator*(typename ExprT::CoeffT Factor,
+                        const PolyExpr<ExprT> &Expr) {
+  return {Expr.self(), Factor};
+}
+
+} // namespace expr
+} // namespace mmath
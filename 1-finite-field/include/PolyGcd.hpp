@@ -0,0 +1,196 @@
+#pragma once
+#include <ModReducer.hpp>
+#include <PolyMul.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace mmath {
+namespace field {
+
+// Degree from which polynom gcd switches from Euclid's algorithm to the
+// half-GCD recursion. Below it the quotients are cheaper to take one by one.
+inline std::size_t PolyHalfGcdThreshold = 512;
+
+namespace detail {
+inline void TrimResidues(Residues &A) {
+  while (!A.empty() && A.back() == 0)
+    A.pop_back();
+}
+
+// A - B.
+inline Residues SubResidues(const ModReducer &R, Residues A,
+                            const Residues &B) {
+  if (A.size() < B.size())
+    A.resize(B.size(), 0);
+  for (std::size_t I = 0; I < B.size(); I++)
+    A[I] = R.sub(A[I], B[I]);
+  TrimResidues(A);
+  return A;
+}
+
+// A B + C D, which is one entry of a 2x2 matrix product.
+inline Residues MulAdd(const ModReducer &R, const Residues &A,
+                       const Residues &B, const Residues &C,
+                       const Residues &D) {
+  auto Res = MulResidues(R, A, B);
+  auto Other = MulResidues(R, C, D);
+  if (Res.size() < Other.size())
+    Res.resize(Other.size(), 0);
+  for (std::size_t I = 0; I < Other.size(); I++)
+    Res[I] = R.add(Res[I], Other[I]);
+  TrimResidues(Res);
+  return Res;
+}
+
+// Replaces A with A mod B and returns the quotient. B must be nonzero and
+// both must be trimmed.
+inline Residues DivRemInPlace(const ModReducer &R, Residues &A,
+                              const Residues &B) {
+  assert(!B.empty() && "Division by zero polynom");
+  if (A.size() < B.size())
+    return {};
+  auto DivDeg = B.size() - 1;
+  auto LeadInv = R.inv(B.back());
+  Residues Quot(A.size() - DivDeg, 0);
+  for (std::size_t I = Quot.size(); I-- > 0;) {
+    auto C = R.mul(A[I + DivDeg], LeadInv);
+    Quot[I] = C;
+    if (C == 0)
+      continue;
+    for (std::size_t J = 0; J < DivDeg; J++)
+      A[I + J] = R.sub(A[I + J], R.mul(C, B[J]));
+  }
+  A.resize(DivDeg);
+  TrimResidues(A);
+  return Quot;
+}
+
+// Drops the K lowest coefficients, i.e. A div x^K.
+inline Residues DropLow(const Residues &A, std::size_t K) {
+  if (K >= A.size())
+    return {};
+  return Residues(A.begin() + K, A.end());
+}
+
+// Product of Euclidean steps. Applied to a pair (A, B) it yields the pair of
+// consecutive remainders (M00 A + M01 B, M10 A + M11 B).
+struct GcdMatrix {
+  Residues M00 = {1}, M01, M10, M11 = {1};
+
+  // Left-multiplies by [[0, 1], [1, -Q]], i.e. (A, B) -> (B, A - Q B).
+  void step(const ModReducer &R, const Residues &Q) {
+    auto New10 = SubResidues(R, M00, MulResidues(R, Q, M10));
+    auto New11 = SubResidues(R, M01, MulResidues(R, Q, M11));
+    M00 = std::move(M10);
+    M01 = std::move(M11);
+    M10 = std::move(New10);
+    M11 = std::move(New11);
+  }
+
+  // Returns Left * *this.
+  GcdMatrix mulLeft(const ModReducer &R, const GcdMatrix &Left) const {
+    GcdMatrix Res;
+    Res.M00 = MulAdd(R, Left.M00, M00, Left.M01, M10);
+    Res.M01 = MulAdd(R, Left.M00, M01, Left.M01, M11);
+    Res.M10 = MulAdd(R, Left.M10, M00, Left.M11, M10);
+    Res.M11 = MulAdd(R, Left.M10, M01, Left.M11, M11);
+    return Res;
+  }
+
+  std::pair<Residues, Residues> apply(const ModReducer &R, const Residues &A,
+                                      const Residues &B) const {
+    return {MulAdd(R, M00, A, M01, B), MulAdd(R, M10, A, M11, B)};
+  }
+};
+
+// For deg A = n > deg B, returns the matrix taking (A, B) to the consecutive
+// remainders (C, D) with deg C >= ceil(n / 2) > deg D. The quotients that get
+// there depend only on the top halves of A and B, so the first half of them
+// comes from a recursive call on A div x^m and B div x^m, and the rest from
+// a second call on the top half of what remains. Each level does O(1)
+// multiplications of size n, so the whole takes O(M(n) log n).
+inline GcdMatrix HalfGcd(const ModReducer &R, const Residues &A,
+                         const Residues &B) {
+  assert(A.size() > B.size() && "Needs deg A > deg B");
+  auto N = A.size() - 1;
+  auto M = (N + 1) / 2;
+  GcdMatrix Res;
+  if (B.size() <= M)
+    return Res;
+
+  if (N < PolyHalfGcdThreshold) {
+    auto C = A, D = B;
+    while (D.size() > M) {
+      auto Q = DivRemInPlace(R, C, D);
+      std::swap(C, D);
+      Res.step(R, Q);
+    }
+    return Res;
+  }
+
+  Res = HalfGcd(R, DropLow(A, M), DropLow(B, M));
+  auto [C, D] = Res.apply(R, A, B);
+  if (D.size() <= M)
+    return Res;
+  auto Q = DivRemInPlace(R, C, D);
+  Res.step(R, Q);
+  if (C.size() <= M)
+    return Res;
+  // Now deg D < 3n / 4, so the top 2 (deg D - m) coefficients of (D, C)
+  // determine the quotients down to degree m.
+  auto K = 2 * M - (D.size() - 1);
+  return Res.mulLeft(R, HalfGcd(R, DropLow(D, K), DropLow(C, K)));
+}
+} // namespace detail
+
+// Returns the monic gcd G of A and B, or the empty residues if both are zero.
+// When S and T are given, also fills them with the Euclidean cofactors, for
+// which S A + T B = G and deg S < deg B.
+// Inputs of degree below PolyHalfGcdThreshold run Euclid's algorithm; longer
+// ones are first cut in half by detail::HalfGcd, which brings the cost down
+// from O(n^2) to O(M(n) log n).
+inline Residues XgcdResidues(const ModReducer &R, Residues A, Residues B,
+                             Residues *S = nullptr, Residues *T = nullptr) {
+  detail::TrimResidues(A);
+  detail::TrimResidues(B);
+  detail::GcdMatrix Steps;
+  while (!B.empty()) {
+    if (A.size() > B.size() && A.size() - 1 >= PolyHalfGcdThreshold) {
+      auto H = detail::HalfGcd(R, A, B);
+      std::tie(A, B) = H.apply(R, A, B);
+      if (S || T)
+        Steps = Steps.mulLeft(R, H);
+      if (B.empty())
+        break;
+    }
+    // A single step also swaps A and B when deg A < deg B, since the
+    // quotient is then zero.
+    auto Q = detail::DivRemInPlace(R, A, B);
+    std::swap(A, B);
+    if (S || T)
+      Steps.step(R, Q);
+  }
+
+  std::uint64_t Norm = A.empty() ? 1 : R.inv(A.back());
+  auto Scale = [&](Residues &V) {
+    for (auto &C : V)
+      C = R.mul(C, Norm);
+  };
+  Scale(A);
+  if (S) {
+    *S = std::move(Steps.M00);
+    Scale(*S);
+  }
+  if (T) {
+    *T = std::move(Steps.M01);
+    Scale(*T);
+  }
+  return A;
+}
+
+} // namespace field
+} // namespace mmath
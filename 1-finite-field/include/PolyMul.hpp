@@ -0,0 +1,247 @@
+#pragma once
+#include <ModReducer.hpp>
+#include <Stats.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mmath {
+namespace field {
+
+// Operand lengths at which polynom multiplication switches algorithms.
+struct MulThresholds {
+  // Operands shorter than this (the shorter one) use schoolbook.
+  std::size_t Karatsuba = 32;
+  // Products at least this long use a number-theoretic transform.
+  std::size_t Ntt = 256;
+};
+
+// Tunable crossovers used by Polynom::mul.
+inline MulThresholds PolyMulThresholds;
+
+using Residues = std::vector<std::uint64_t>;
+
+inline Residues SchoolbookMul(const ModReducer &R, const Residues &A,
+                              const Residues &B) {
+  if (A.empty() || B.empty())
+    return {};
+  Residues Res(A.size() + B.size() - 1, 0);
+  for (std::size_t I = 0; I < A.size(); I++)
+    for (std::size_t J = 0; J < B.size(); J++)
+      Res[I + J] = R.add(Res[I + J], R.mul(A[I], B[J]));
+  return Res;
+}
+
+namespace detail {
+// Out[0, 2N - 1) = A[0, N) * B[0, N).
+inline void KaratsubaRec(const ModReducer &R, const std::uint64_t *A,
+                         const std::uint64_t *B, std::size_t N,
+                         std::uint64_t *Out, std::size_t Threshold) {
+  if (N < Threshold || N < 2) {
+    std::fill(Out, Out + 2 * N - 1, 0);
+    for (std::size_t I = 0; I < N; I++)
+      for (std::size_t J = 0; J < N; J++)
+        Out[I + J] = R.add(Out[I + J], R.mul(A[I], B[J]));
+    return;
+  }
+  // A = A0 + A1 x^K with deg A0 < K and deg A1 < N - K <= K.
+  std::size_t K = (N + 1) / 2, H = N - K;
+  Residues SumA(A, A + K), SumB(B, B + K);
+  for (std::size_t I = 0; I < H; I++) {
+    SumA[I] = R.add(SumA[I], A[K + I]);
+    SumB[I] = R.add(SumB[I], B[K + I]);
+  }
+  Residues Z0(2 * K - 1), Z1(2 * K - 1), Z2(2 * H - 1);
+  KaratsubaRec(R, A, B, K, Z0.data(), Threshold);
+  KaratsubaRec(R, A + K, B + K, H, Z2.data(), Threshold);
+  KaratsubaRec(R, SumA.data(), SumB.data(), K, Z1.data(), Threshold);
+  for (std::size_t I = 0; I < Z0.size(); I++)
+    Z1[I] = R.sub(Z1[I], Z0[I]);
+  for (std::size_t I = 0; I < Z2.size(); I++)
+    Z1[I] = R.sub(Z1[I], Z2[I]);
+
+  std::fill(Out, Out + 2 * N - 1, 0);
+  for (std::size_t I = 0; I < Z0.size(); I++)
+    Out[I] = Z0[I];
+  for (std::size_t I = 0; I < Z2.size(); I++)
+    Out[2 * K + I] = Z2[I];
+  for (std::size_t I = 0; I < Z1.size(); I++)
+    Out[K + I] = R.add(Out[K + I], Z1[I]);
+}
+
+// Returns a primitive 2^Log-th root of unity modulo the prime R.getModulus(),
+// or 0 if there is none.
+inline std::uint64_t RootOfUnity(const ModReducer &R, unsigned Log) {
+  auto Q = R.getModulus();
+  if (Q < 3 || Log >= 64 || (Q - 1) % (std::uint64_t(1) << Log) != 0)
+    return 0;
+  if (Log == 0)
+    return 1;
+  // W = A^((q - 1) / 2^Log) has order exactly 2^Log iff A is a quadratic
+  // non-residue, which holds for half of all A.
+  for (std::uint64_t A = 2; A < Q; A++) {
+    auto W = R.pow(A, (Q - 1) >> Log);
+    if (R.pow(W, std::uint64_t(1) << (Log - 1)) == Q - 1)
+      return W;
+  }
+  return 0;
+}
+
+// In-place iterative radix-2 transform of length 2^k, where Root is a
+// primitive root of unity of that order.
+inline void Ntt(const ModReducer &R, Residues &A, std::uint64_t Root) {
+  std::size_t N = A.size();
+  for (std::size_t I = 1, J = 0; I < N; I++) {
+    std::size_t Bit = N >> 1;
+    for (; J & Bit; Bit >>= 1)
+      J ^= Bit;
+    J ^= Bit;
+    if (I < J)
+      std::swap(A[I], A[J]);
+  }
+  Residues Powers;
+  for (std::size_t Len = 2; Len <= N; Len <<= 1) {
+    auto Step = R.pow(Root, N / Len);
+    Powers.assign(Len / 2, 0);
+    Powers[0] = R.reduce(1);
+    for (std::size_t I = 1; I < Len / 2; I++)
+      Powers[I] = R.mul(Powers[I - 1], Step);
+    for (std::size_t I = 0; I < N; I += Len)
+      for (std::size_t J = 0; J < Len / 2; J++) {
+        auto U = A[I + J];
+        auto V = R.mul(A[I + J + Len / 2], Powers[J]);
+        A[I + J] = R.add(U, V);
+        A[I + J + Len / 2] = R.sub(U, V);
+      }
+  }
+}
+
+// Cyclic convolution modulo R.getModulus() with transforms of length 2^Log.
+// Root must be a primitive 2^Log-th root of unity.
+inline Residues NttConvolve(const ModReducer &R, Residues A, Residues B,
+                            unsigned Log, std::uint64_t Root) {
+  std::size_t N = std::size_t(1) << Log;
+  std::size_t ResSize = A.size() + B.size() - 1;
+  A.resize(N, 0);
+  B.resize(N, 0);
+  Ntt(R, A, Root);
+  Ntt(R, B, Root);
+  for (std::size_t I = 0; I < N; I++)
+    A[I] = R.mul(A[I], B[I]);
+  Ntt(R, A, R.inv(Root));
+  auto NInv = R.inv(R.reduce(N));
+  A.resize(ResSize);
+  for (auto &V : A)
+    V = R.mul(V, NInv);
+  return A;
+}
+
+// NTT-friendly primes below 2^62. q - 1 is divisible by 2^46, 2^41 and 2^42
+// respectively, so all three support transforms of length up to
+// CrtMaxLog = 41. Their product exceeds 2^185, which bounds every
+// coefficient of an integer product of two polynoms with coefficients below
+// 2^63 and at most 2^41 terms.
+constexpr std::uint64_t CrtPrimes[3] = {
+    4611615649683210241ULL, 4611613450659954689ULL, 4611549678985543681ULL};
+constexpr unsigned CrtMaxLog = 41;
+} // namespace detail
+
+inline Residues KaratsubaMul(const ModReducer &R, const Residues &A,
+                             const Residues &B) {
+  if (A.empty() || B.empty())
+    return {};
+  std::size_t N = std::max(A.size(), B.size());
+  Residues PaddedA(A), PaddedB(B);
+  PaddedA.resize(N, 0);
+  PaddedB.resize(N, 0);
+  Residues Res(2 * N - 1);
+  detail::KaratsubaRec(R, PaddedA.data(), PaddedB.data(), N, Res.data(),
+                       std::max<std::size_t>(PolyMulThresholds.Karatsuba, 2));
+  Res.resize(A.size() + B.size() - 1);
+  return Res;
+}
+
+// Multiplies with a number-theoretic transform modulo the field prime when it
+// has roots of unity of the needed order, and otherwise modulo three fixed
+// NTT primes followed by CRT reconstruction.
+inline Residues NttMul(const ModReducer &R, const Residues &A,
+                       const Residues &B) {
+  if (A.empty() || B.empty())
+    return {};
+  std::size_t ResSize = A.size() + B.size() - 1;
+  unsigned Log = 0;
+  while ((std::size_t(1) << Log) < ResSize)
+    Log++;
+
+  if (auto Root = detail::RootOfUnity(R, Log))
+    return detail::NttConvolve(R, A, B, Log, Root);
+
+  assert(Log <= detail::CrtMaxLog && "Product too long for the CRT primes");
+  Residues Parts[3];
+  ModReducer Mods[3] = {ModReducer(detail::CrtPrimes[0]),
+                        ModReducer(detail::CrtPrimes[1]),
+                        ModReducer(detail::CrtPrimes[2])};
+  for (int I = 0; I < 3; I++)
+    Parts[I] = detail::NttConvolve(Mods[I], A, B, Log,
+                                   detail::RootOfUnity(Mods[I], Log));
+
+  // Garner: X = R0 + Q0 * T1 + Q0 * Q1 * T2 with T1 < Q1 and T2 < Q2.
+  auto Q0 = detail::CrtPrimes[0], Q1 = detail::CrtPrimes[1];
+  auto Q0InvMod1 = Mods[1].inv(Mods[1].reduce(Q0));
+  auto Q0Q1InvMod2 = Mods[2].inv(Mods[2].mul(Mods[2].reduce(Q0), Q1));
+  auto Q0Mod2 = Mods[2].reduce(Q0);
+  auto Q0ModP = R.reduce(Q0);
+  auto Q0Q1ModP = R.mul(Q0ModP, R.reduce(Q1));
+  Residues Res(ResSize);
+  for (std::size_t I = 0; I < ResSize; I++) {
+    auto R0 = Parts[0][I];
+    auto T1 = Mods[1].mul(Mods[1].sub(Parts[1][I], Mods[1].reduce(R0)),
+                          Q0InvMod1);
+    auto Partial = Mods[2].add(Mods[2].reduce(R0), Mods[2].mul(Q0Mod2, T1));
+    auto T2 = Mods[2].mul(Mods[2].sub(Parts[2][I], Partial), Q0Q1InvMod2);
+    Res[I] = R.add(R.add(R.reduce(R0), R.mul(Q0ModP, R.reduce(T1))),
+                   R.mul(Q0Q1ModP, R.reduce(T2)));
+  }
+  return Res;
+}
+
+// Picks schoolbook, Karatsuba or NTT multiplication by operand size.
+inline Residues MulResidues(const ModReducer &R, const Residues &A,
+                            const Residues &B) {
+  if (A.empty() || B.empty())
+    return {};
+  if (std::min(A.size(), B.size()) < PolyMulThresholds.Karatsuba)
+    return SchoolbookMul(R, A, B);
+  if (A.size() + B.size() - 1 < PolyMulThresholds.Ntt) {
+    stats::count(stats::Counter::PolyMulKaratsuba);
+    return KaratsubaMul(R, A, B);
+  }
+  stats::count(stats::Counter::PolyMulNtt);
+  return NttMul(R, A, B);
+}
+
+// Returns A^-1 mod x^Len by Newton iteration G <- G (2 - A G), which doubles
+// the precision of G each step. A[0] must be nonzero.
+inline Residues InvSeries(const ModReducer &R, const Residues &A,
+                          std::size_t Len) {
+  assert(!A.empty() && A[0] != 0 && "Constant term must be invertible");
+  Residues G = {R.inv(A[0])};
+  for (std::size_t Prec = 1; Prec < Len;) {
+    Prec = std::min(2 * Prec, Len);
+    Residues Head(A.begin(), A.begin() + std::min(Prec, A.size()));
+    auto E = MulResidues(R, Head, G);
+    E.resize(Prec, 0);
+    for (auto &C : E)
+      C = R.neg(C);
+    E[0] = R.add(E[0], R.reduce(2));
+    G = MulResidues(R, G, E);
+    G.resize(Prec, 0);
+  }
+  G.resize(Len, 0);
+  return G;
+}
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,129 @@
+#pragma once
+#include <ModReducer.hpp>
+#include <PolyMul.hpp>
+#include <Polynom.hpp>
+#include <Stats.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mmath {
+namespace field {
+
+// Remainder-only reduction modulo a fixed polynom f of degree m >= 1.
+//
+// The reversed inverse g = rev(f)^-1 mod x^m is precomputed once by Newton
+// iteration. A polynom a of degree n - 1 < 2m then reduces Barrett-style:
+// the quotient is the reverse of rev(a) * g mod x^(n - m), and the remainder
+// is the low m coefficients of a - q * f. Both products are truncated, so no
+// quotient polynom or shifted divisor copy is ever built.
+template <class FieldT> class PolyReducer {
+public:
+  using ElementType = Polynom<FieldT>;
+
+  PolyReducer() = default;
+
+  PolyReducer(const FieldT *Field, const ElementType &Modulus)
+      : Field(Field), R(Field->getOrder()) {
+    assert(Modulus.getDegree().value_or(0) >= 1 &&
+           "Modulus must have degree >= 1");
+    const auto &Coeffs = Modulus.getCoeffs();
+    M = Coeffs.size() - 1;
+    auto LeadInv = R.inv(std::uint64_t(Coeffs.back()));
+    FLow.resize(M);
+    for (std::size_t I = 0; I < M; I++)
+      FLow[I] = R.mul(std::uint64_t(Coeffs[I]), LeadInv);
+    buildInverse();
+  }
+
+  bool isInitialized() const { return M != 0; }
+
+  std::size_t getModulusDegree() const { return M; }
+
+  // Replaces A with A mod f. Allocation-free once the per-thread scratch
+  // buffer has grown to 2m entries and while m is below the Karatsuba
+  // crossover.
+  void reduceInPlace(ElementType &A) const {
+    assert(isInitialized() && "Reducer has no modulus");
+    assert(A.Field == Field && "Polynom is over another field");
+    stats::count(stats::Counter::PolyReduce);
+    auto N = A.Coeffs.size();
+    if (N <= M)
+      return;
+
+    thread_local Residues Scratch;
+    Scratch.resize(N + M);
+    auto *Coeffs = Scratch.data();
+    auto *Quot = Coeffs + N;
+    for (std::size_t I = 0; I < N; I++)
+      Coeffs[I] = std::uint64_t(A.Coeffs[I]);
+
+    // Inputs longer than 2m are first folded by plain long division.
+    for (; N > 2 * M; N--) {
+      auto Top = Coeffs[N - 1];
+      if (Top != 0)
+        for (std::size_t J = 0; J < M; J++)
+          Coeffs[N - 1 - M + J] =
+              R.sub(Coeffs[N - 1 - M + J], R.mul(Top, FLow[J]));
+    }
+
+    auto K = N - M;
+    if (K < PolyMulThresholds.Karatsuba) {
+      // Quot[K - 1 - J] = (rev(a) * g)[J] for J < K.
+      for (std::size_t J = 0; J < K; J++) {
+        std::uint64_t Sum = 0;
+        for (std::size_t T = 0; T <= J; T++)
+          Sum = R.add(Sum, R.mul(Coeffs[N - 1 - T], InvRev[J - T]));
+        Quot[K - 1 - J] = Sum;
+      }
+      for (std::size_t I = 0; I < M; I++) {
+        auto Sum = Coeffs[I];
+        for (std::size_t J = 0, End = std::min(I + 1, K); J < End; J++)
+          Sum = R.sub(Sum, R.mul(Quot[J], FLow[I - J]));
+        Coeffs[I] = Sum;
+      }
+    } else {
+      Residues RevTop(K), InvLow(InvRev.begin(), InvRev.begin() + K);
+      for (std::size_t T = 0; T < K; T++)
+        RevTop[T] = Coeffs[N - 1 - T];
+      auto QuotRev = MulResidues(R, RevTop, InvLow);
+      Residues Q(K);
+      for (std::size_t J = 0; J < K; J++)
+        Q[K - 1 - J] = QuotRev[J];
+      auto QF = MulResidues(R, Q, FLow);
+      for (std::size_t I = 0; I < M && I < QF.size(); I++)
+        Coeffs[I] = R.sub(Coeffs[I], QF[I]);
+    }
+
+    A.Coeffs.resize(M, Field->zero());
+    for (std::size_t I = 0; I < M; I++)
+      A.Coeffs[I] = Field->getValue(Coeffs[I]);
+    A.normalize();
+  }
+
+  ElementType reduce(ElementType A) const {
+    reduceInPlace(A);
+    return A;
+  }
+
+private:
+  const FieldT *Field = nullptr;
+  ModReducer R;
+  std::size_t M = 0;
+  // Low coefficients of f / lc(f), which is monic of degree m.
+  Residues FLow;
+  // rev(f / lc(f))^-1 mod x^m.
+  Residues InvRev;
+
+  void buildInverse() {
+    Residues RevF(M + 1);
+    RevF[0] = R.reduce(1);
+    for (std::size_t I = 1; I <= M; I++)
+      RevF[I] = FLow[M - I];
+    InvRev = InvSeries(R, RevF, M);
+  }
+};
+
+} // namespace field
+} // namespace mmath
@@ -1,4 +1,9 @@
 #pragma once
+#include <PolyEval.hpp>
+#include <PolyExpr.hpp>
+#include <PolyGcd.hpp>
+#include <PolyMul.hpp>
+#include <Stats.hpp>
 #include <algorithm>
 #include <assert.h>
 #include <cstddef>
@@ -8,164 +13,170 @@
 #include <vector>
 
 namespace mmath {
-template <class FieldT> struct Monom {
+namespace field {
+template <class FieldT> class PolyReducer;
+} // namespace field
+
+// Sums, differences, scaling and shifts also have lazy operator forms, see
+// PolyExpr.hpp: A = B + C.shift(K) * X writes into the storage of A in one
+// pass without temporaries.
+template <class FieldT> class Polynom : public expr::PolyExpr<Polynom<FieldT>> {
+public:
+  using FieldType = FieldT;
   using CoeffT = typename FieldT::ElementType;
 
-  Monom<FieldT>(const Monom<FieldT> &P)
-      : Degree(P.Degree), Coeff(P.Coeff), Field(P.Field) {}
-  Monom<FieldT>(Monom<FieldT> &&P) = default;
-  Monom<FieldT> &operator=(const Monom<FieldT> &P) = default;
-  Monom<FieldT> &operator=(Monom<FieldT> &&P) = default;
+private:
+  friend class field::PolyReducer<FieldT>;
 
-  Monom(const FieldT *Field, CoeffT Coefficient, std::size_t Degree)
-      : Field(Field), Degree(Degree), Coeff(Coefficient) {}
+  // Dense coefficients indexed by degree. Trailing zero coefficients are never
+  // stored, so the degree is always Coeffs.size() - 1 and the zero polynom has
+  // no coefficients at all.
+  std::vector<CoeffT> Coeffs;
 
-  Monom sum(const Monom &Other) {
-    return const_cast<const Monom *>(this)->sum(Other);
-  }
+  const FieldT *Field;
+  std::size_t getDegreeOrZero() const { return getDegree().value_or(0); }
 
-  Monom sum(const Monom &Other) const {
-    assert(Degree == Other.Degree || Coeff == Field->zero() ||
-           Other.Coeff == Field->zero() && "Monoms degrees must match");
-    return Monom(Coeff + Other.Coeff, Degree);
+  // Drops trailing zero coefficients to restore the storage invariant.
+  void normalize() {
+    auto Zero = Field->zero();
+    while (!Coeffs.empty() && Coeffs.back() == Zero)
+      Coeffs.pop_back();
   }
 
-  Monom &sumInPlace(const Monom &Other) {
-    assert(Degree == Other.Degree || Coeff == Field->zero() ||
-           Other.Coeff == Field->zero() && "Monoms degrees must match");
-    Coeff += Other.Coeff;
-    return *this;
+  field::Residues toResidues() const {
+    return field::Residues(Coeffs.begin(), Coeffs.end());
   }
 
-  Monom mul(CoeffT MulCoeff) const { return Monom(Coeff * MulCoeff, Degree); }
-
-  Monom mul(CoeffT MulCoeff) {
-    return const_cast<const Monom *>(this)->mul(MulCoeff);
+  std::vector<CoeffT> toCoeffs(const field::Residues &Values) const {
+    std::vector<CoeffT> Res;
+    Res.reserve(Values.size());
+    for (auto V : Values)
+      Res.push_back(Field->getValue(V));
+    return Res;
   }
 
-  Monom &mulInPlace(CoeffT MulCoeff) {
-    Coeff *= MulCoeff;
-    return *this;
+  // Grows Coeffs to Size coefficients, counting real allocations.
+  void reserveCoeffs(std::size_t Size) {
+    if (Size > Coeffs.capacity())
+      field::stats::count(field::stats::Counter::PolyAlloc);
+    if (Size > Coeffs.size())
+      Coeffs.resize(Size, Field->zero());
   }
 
-  Monom mul(const Monom &Other) const {
-    return Monom(Coeff * Other.Coeff, Degree + Other.Degree);
+  // Writes Expr into Coeffs from the highest coefficient down. Expressions
+  // only read coefficient I or, through shifts, lower ones when producing
+  // coefficient I, so *this may appear in Expr.
+  template <class ExprT> void assignExpr(const ExprT &Expr) {
+    auto Size = Expr.size();
+    reserveCoeffs(Size);
+    for (auto I = Size; I-- > 0;)
+      Coeffs[I] = Expr.coeffAt(I);
+    Coeffs.resize(Size, Field->zero());
+    normalize();
   }
 
-  Monom mul(const Monom &Other) {
-    return const_cast<const Monom *>(this)->mul(Other);
+  Polynom<FieldT> fromResidues(const field::Residues &Values) const {
+    field::stats::count(field::stats::Counter::PolyAlloc);
+    return Polynom<FieldT>(Field, toCoeffs(Values));
   }
 
-  Monom operator+(const Monom &Other) const { return sum(Other); }
-
-  Monom operator+(const Monom &Other) { return sum(Other); }
-
-  Monom &operator+=(const Monom &Other) { return sumInPlace(Other); }
-
-  Monom operator*(CoeffT MulCoeff) const { return mul(MulCoeff); }
-
-  Monom operator*(CoeffT MulCoeff) { return mul(MulCoeff); }
-
-  Monom &operator*=(CoeffT MulCoeff) { return mulInPlace(MulCoeff); }
-
-  Monom operator*(const Monom &Other) const { return mul(Other); }
-
-  Monom operator*(const Monom &Other) { return mul(Other); }
-
-  std::size_t Degree;
-  CoeffT Coeff;
-  const FieldT *Field;
-};
-
-template <class FieldT> class Polynom {
-public:
-  using CoeffT = typename FieldT::ElementType;
-
-private:
-  std::vector<Monom<FieldT>> Monoms;
-
-  const FieldT *Field;
-  std::size_t getDegreeOrZero() const { return getDegree().value_or(0); }
-
 public:
   explicit Polynom(const FieldT *Field) : Field(Field) {}
 
   Polynom(const FieldT *Field, const std::vector<CoeffT> &Coefficients)
-      : Field(Field) {
-    std::size_t Idx = 0;
-    Monoms.reserve(Coefficients.size());
-    for (auto &Coeff : Coefficients)
-      Monoms.emplace_back(Field, Coeff, Idx++);
+      : Coeffs(Coefficients), Field(Field) {
+    field::stats::count(field::stats::Counter::PolyAlloc);
+    normalize();
+  }
+
+  Polynom(const FieldT *Field, std::vector<CoeffT> &&Coefficients)
+      : Coeffs(std::move(Coefficients)), Field(Field) {
+    normalize();
   }
 
-  Polynom(const Polynom &P) = default;
+  // Copies are counted as allocations; moves are free.
+  Polynom(const Polynom &P) : Coeffs(P.Coeffs), Field(P.Field) {
+    field::stats::count(field::stats::Counter::PolyAlloc);
+  }
   Polynom(Polynom &&P) = default;
-  Polynom &operator=(const Polynom &P) = default;
+  Polynom &operator=(const Polynom &P) {
+    field::stats::count(field::stats::Counter::PolyAlloc);
+    Coeffs = P.Coeffs;
+    Field = P.Field;
+    return *this;
+  }
   Polynom &operator=(Polynom &&P) = default;
 
-  void clear() { Monoms.clear(); }
+  // Evaluates a lazy expression.
+  template <class ExprT>
+  Polynom(const expr::PolyExpr<ExprT> &Expr) : Field(Expr.self().getField()) {
+    assignExpr(Expr.self());
+  }
 
-  std::optional<std::size_t> getDegree() const {
-    const Monom<FieldT> *MaxDegMonom = nullptr;
+  // Evaluates a lazy expression into the existing storage, which only
+  // allocates if it has to grow.
+  template <class ExprT>
+  Polynom &operator=(const expr::PolyExpr<ExprT> &Expr) {
+    assignExpr(Expr.self());
+    return *this;
+  }
 
-    for (auto &M : Monoms)
-      if (M.Coeff != Field->zero() &&
-          (!MaxDegMonom || M.Degree > MaxDegMonom->Degree))
-        MaxDegMonom = &M;
+  template <class ExprT>
+  Polynom &operator+=(const expr::PolyExpr<ExprT> &Expr) {
+    assignExpr(*this + Expr);
+    return *this;
+  }
 
-    if (!MaxDegMonom)
-      return std::nullopt;
-    return MaxDegMonom->Degree;
+  template <class ExprT>
+  Polynom &operator-=(const expr::PolyExpr<ExprT> &Expr) {
+    assignExpr(*this - Expr);
+    return *this;
   }
 
-  bool isZero() const {
-    auto Deg = getDegree();
-    return !Deg;
+  Polynom &operator*=(CoeffT MulCoeff) { return mulInPlace(MulCoeff); }
+
+  void clear() { Coeffs.clear(); }
+
+  // Expression interface.
+  const FieldT *getField() const { return Field; }
+  std::size_t size() const { return Coeffs.size(); }
+  CoeffT coeffAt(std::size_t I) const { return getCoeffAt(I); }
+
+  std::optional<std::size_t> getDegree() const {
+    if (Coeffs.empty())
+      return std::nullopt;
+    return Coeffs.size() - 1;
   }
 
+  bool isZero() const { return Coeffs.empty(); }
+
   bool isCoeff(CoeffT C) const {
-    auto Deg = getDegree();
-    if (Deg && *Deg != Field->zero())
+    if (Coeffs.size() > 1)
       return false;
-    // std::cout << "Coeff at 0 degree " << getCoeffAt(0) << "\n";
     return getCoeffAt(0) == C;
   }
 
-  void sort() {
-    std::sort(Monoms.begin(), Monoms.end(),
-              [](const Monom<FieldT> &M1, const Monom<FieldT> &M2) {
-                return M1.Degree < M2.Degree;
-              });
-  }
+  // Coefficients are always kept normalized, so this only releases unused
+  // capacity.
+  void trim() { Coeffs.shrink_to_fit(); }
 
-  void trim() {
-    for (auto It = Monoms.begin(); It != Monoms.end();) {
-      if (It->Coeff == Field->zero())
-        It = Monoms.erase(It);
-      else
-        ++It;
-    }
-    Monoms.shrink_to_fit();
-    sort();
-  }
+  const std::vector<CoeffT> &getCoeffs() const { return Coeffs; }
 
   void setCoeffAt(std::size_t CoeffDeg, CoeffT Coeff) {
-    for (auto It = Monoms.begin(); It != Monoms.end(); ++It)
-      if (It->Degree == CoeffDeg) {
-        Monoms.erase(It);
-        break;
-      }
-    Monoms.emplace_back(Field, Coeff, CoeffDeg);
+    if (CoeffDeg >= Coeffs.size()) {
+      if (Coeff == Field->zero())
+        return;
+      Coeffs.resize(CoeffDeg + 1, Field->zero());
+    }
+    Coeffs[CoeffDeg] = Coeff;
+    if (CoeffDeg + 1 == Coeffs.size())
+      normalize();
   }
 
   CoeffT getCoeffAt(std::size_t CoeffDeg) const {
-    auto Deg = getDegree();
-    if (!Deg || *Deg < CoeffDeg)
+    if (CoeffDeg >= Coeffs.size())
       return Field->zero();
-    for (auto &M : Monoms)
-      if (M.Degree == CoeffDeg)
-        return M.Coeff;
-    return Field->zero();
+    return Coeffs[CoeffDeg];
   }
 
   Polynom<FieldT> sum(const Polynom<FieldT> &Other) {
@@ -173,46 +184,60 @@ public:
   }
 
   Polynom<FieldT> sum(const Polynom<FieldT> &Other) const {
-    std::size_t MaxDegree = std::max(getDegreeOrZero(), getDegreeOrZero());
-    std::vector<CoeffT> Coeffs;
-    for (std::size_t Deg = 0; Deg <= MaxDegree; Deg++)
-      Coeffs.emplace_back(getCoeffAt(Deg) + Other.getCoeffAt(Deg), Field);
-    return Polynom<FieldT>(Field, Coeffs);
+    return *this + Other;
   }
 
   Polynom<FieldT> &sumInPlace(const Polynom<FieldT> &Other) {
-    std::size_t MaxDegree = std::max(getDegreeOrZero(), getDegreeOrZero());
-    for (std::size_t Deg = 0; Deg <= MaxDegree; Deg++)
-      setCoeffAt(Deg, getCoeffAt(Deg) + Other.getCoeffAt(Deg));
-    return *this;
+    return *this += Other;
   }
 
-  Polynom<FieldT> mul(CoeffT MulCoeff) const {
-    Polynom<FieldT> Poly(Field, *this);
-    return Poly.mulInPlace(MulCoeff);
-  }
+  Polynom<FieldT> mul(CoeffT MulCoeff) const { return *this * MulCoeff; }
 
   Polynom<FieldT> &mulInPlace(CoeffT MulCoeff) {
-    for (auto &M : Monoms)
-      M.mulInPlace(MulCoeff);
+    if (MulCoeff == Field->zero()) {
+      Coeffs.clear();
+      return *this;
+    }
+    for (auto &C : Coeffs)
+      C *= MulCoeff;
     return *this;
   }
 
   Polynom<FieldT> mul(const Polynom<FieldT> &Other) const {
-    Polynom<FieldT> ResPoly(Field);
-
-    auto Degree = getDegreeOrZero();
-    auto RDegree = Other.getDegreeOrZero();
-    for (std::size_t LDeg = 0; LDeg <= Degree; LDeg++) {
-      auto LCoeff = getCoeffAt(LDeg);
-      for (std::size_t RDeg = 0; RDeg <= RDegree; RDeg++) {
-        auto RCoeff = Other.getCoeffAt(RDeg);
-        auto Deg = LDeg + RDeg;
-        auto Coeff = ResPoly.getCoeffAt(Deg);
-        ResPoly.setCoeffAt(Deg, Coeff + (LCoeff * RCoeff));
-      }
+    Polynom<FieldT> Res(Field);
+    return Res.assignMul(*this, Other);
+  }
+
+  // *this = A * B, reusing the storage of *this when short operands are
+  // multiplied. Neither operand may be *this. Loops that keep multiplying
+  // can alternate between two polynoms and stop allocating.
+  Polynom<FieldT> &assignMul(const Polynom<FieldT> &A,
+                             const Polynom<FieldT> &B) {
+    assert(this != &A && this != &B && "Product must not alias an operand");
+    field::stats::count(field::stats::Counter::PolyMul);
+    Coeffs.clear();
+    if (A.isZero() || B.isZero())
+      return *this;
+
+    // Long operands go through Karatsuba or NTT on raw residues.
+    if (std::min(A.Coeffs.size(), B.Coeffs.size()) >=
+        field::PolyMulThresholds.Karatsuba) {
+      field::stats::count(field::stats::Counter::PolyAlloc);
+      Coeffs = toCoeffs(field::MulResidues(
+          field::ModReducer(Field->getOrder()), A.toResidues(),
+          B.toResidues()));
+      normalize();
+      return *this;
+    }
+
+    reserveCoeffs(A.Coeffs.size() + B.Coeffs.size() - 1);
+    for (std::size_t LDeg = 0; LDeg < A.Coeffs.size(); LDeg++) {
+      const auto &LCoeff = A.Coeffs[LDeg];
+      for (std::size_t RDeg = 0; RDeg < B.Coeffs.size(); RDeg++)
+        Coeffs[LDeg + RDeg] += LCoeff * B.Coeffs[RDeg];
     }
-    return ResPoly;
+    normalize();
+    return *this;
   }
 
   Polynom<FieldT> mul(const Polynom<FieldT> &Other) {
@@ -220,61 +245,128 @@ public:
   }
 
   Polynom<FieldT> &shiftDegInPlace(std::size_t Shift) {
-    for (auto &M : Monoms)
-      M.Degree += Shift;
+    if (!isZero())
+      Coeffs.insert(Coeffs.begin(), Shift, Field->zero());
     return *this;
   }
 
   Polynom<FieldT> shiftDegrees(std::size_t Shift) const {
-    Polynom<FieldT> P(*this);
-    return P.shiftDegInPlace(Shift);
+    return this->shift(Shift);
   }
 
   // Returns quotient and fills the Remainder polynom.
   Polynom<FieldT> div(const Polynom<FieldT> &Divisor,
-                      Polynom<FieldT> &Remainder) {
+                      Polynom<FieldT> &Remainder) const {
     assert(Remainder.isZero() &&
            "Remainder must be zero when passed to div function");
     assert(Divisor.getDegree().has_value() && "Must have degree >= 0");
+    field::stats::count(field::stats::Counter::PolyDiv);
+    field::stats::count(field::stats::Counter::PolyAlloc);
+
+    std::vector<CoeffT> Res(Coeffs);
+    auto DivDeg = Divisor.Coeffs.size() - 1;
+    if (Res.size() <= DivDeg) {
+      Remainder.Coeffs = std::move(Res);
+      return Polynom<FieldT>(Field);
+    }
 
-    auto CmpDegress = [](const Polynom &LHS, const Polynom &RHS) -> int {
-      auto Deg1 = LHS.getDegree();
-      auto Deg2 = RHS.getDegree();
-      if (!Deg1) {
-        if (!Deg2)
-          return 0;
-        return -1;
-      }
-      if (!Deg2 || *Deg1 > *Deg2)
-        return 1;
-      return (*Deg1 == *Deg2) ? 0 : -1;
-    };
-
-    Polynom<FieldT> ResPoly(*this);
-    Polynom<FieldT> Quotient(Field);
-    // While deg(Res) >= deg(Divisor)
-    while (CmpDegress(ResPoly, Divisor) >= 0) {
-      auto ResDeg = ResPoly.getDegree().value();
-      auto DivDeg = Divisor.getDegree().value();
+    auto Zero = Field->zero();
+    auto LeadInv = Divisor.Coeffs.back().inverseMul();
+    field::stats::count(field::stats::Counter::PolyAlloc);
+    std::vector<CoeffT> Quotient(Res.size() - DivDeg, Zero);
+    // Eliminate the leading coefficient of the running remainder, from the
+    // highest degree down to deg(Divisor).
+    for (std::size_t ResDeg = Res.size() - 1; ResDeg >= DivDeg; ResDeg--) {
       auto DegDiff = ResDeg - DivDeg;
-      auto CurrDiv = Divisor.shiftDegrees(DegDiff);
-      auto C1 = ResPoly.getCoeffAt(ResDeg);
-      auto C2 = CurrDiv.getCoeffAt(CurrDiv.getDegreeOrZero());
-      auto Coeff = C1.div(C2);
-      Quotient.setCoeffAt(DegDiff, Coeff);
-      CurrDiv.mulInPlace(Coeff.inverseSumInPlace());
-      ResPoly.sumInPlace(CurrDiv);
+      if (Res[ResDeg] != Zero) {
+        auto Coeff = Res[ResDeg] * LeadInv;
+        Quotient[DegDiff] = Coeff;
+        auto NegCoeff = Coeff.inverseSum();
+        for (std::size_t Deg = 0; Deg <= DivDeg; Deg++)
+          Res[DegDiff + Deg] += NegCoeff * Divisor.Coeffs[Deg];
+      }
+      if (ResDeg == 0)
+        break;
     }
-    Remainder = ResPoly;
-    return Quotient;
+    Res.resize(DivDeg, Zero);
+    Remainder.Coeffs = std::move(Res);
+    Remainder.normalize();
+    return Polynom<FieldT>(Field, std::move(Quotient));
+  }
+
+  // Returns the monic gcd of *this and Other, or zero if both are zero.
+  Polynom<FieldT> gcd(const Polynom<FieldT> &Other) const {
+    return fromResidues(
+        field::XgcdResidues(field::ModReducer(Field->getOrder()),
+                            toResidues(), Other.toResidues()));
+  }
+
+  // Returns the monic gcd G of *this and Other and fills S and T so that
+  // S * this + T * Other = G. Long operands go through half-GCD.
+  Polynom<FieldT> xgcd(const Polynom<FieldT> &Other, Polynom<FieldT> &S,
+                       Polynom<FieldT> &T) const {
+    field::Residues SRes, TRes;
+    auto G = field::XgcdResidues(field::ModReducer(Field->getOrder()),
+                                 toResidues(), Other.toResidues(), &SRes,
+                                 &TRes);
+    S = fromResidues(SRes);
+    T = fromResidues(TRes);
+    return fromResidues(G);
+  }
+
+  // Value at X by Horner's rule.
+  CoeffT evaluate(CoeffT X) const {
+    auto Res = Field->zero();
+    for (std::size_t Deg = Coeffs.size(); Deg-- > 0;)
+      Res = Res * X + Coeffs[Deg];
+    return Res;
   }
 
-  Polynom<FieldT> pow(std::size_t Pow) {
-    if (Pow == 0)
-      return Polynom<FieldT>(Field, {Field->one()});
-    Polynom<FieldT> Res(*this);
-    for (std::size_t I = 1; I < Pow; I++)
-      Res = Res.mul(*this);
+  // Values at all points of Tree, in O(M(n) log n) for n points.
+  std::vector<CoeffT> evaluate(const field::SubproductTree &Tree) const {
+    assert(Tree.getModulus() == Field->getOrder() &&
+           "Tree is over another field");
+    return toCoeffs(Tree.evaluate(toResidues()));
+  }
+
+  // Values at all Points. Build the tree once and use the overload above
+  // to evaluate several polynoms at the same points.
+  std::vector<CoeffT> evaluate(const std::vector<CoeffT> &Points) const {
+    return evaluate(field::SubproductTree(Field->getOrder(), Points));
+  }
+
+  // The unique polynom of degree < n taking Values[i] at the i-th point of
+  // Tree, in O(M(n) log n).
+  static Polynom<FieldT> interpolate(const FieldT *Field,
+                                     const field::SubproductTree &Tree,
+                                     const std::vector<CoeffT> &Values) {
+    assert(Tree.getModulus() == Field->getOrder() &&
+           "Tree is over another field");
+    Polynom<FieldT> Res(Field);
+    return Res.fromResidues(
+        Tree.interpolate(field::Residues(Values.begin(), Values.end())));
+  }
+
+  // Points must be distinct.
+  static Polynom<FieldT> interpolate(const FieldT *Field,
+                                     const std::vector<CoeffT> &Points,
+                                     const std::vector<CoeffT> &Values) {
+    return interpolate(Field, field::SubproductTree(Field->getOrder(), Points),
+                       Values);
+  }
+
+  // Square-and-multiply without any reduction, so the result has degree
+  // Pow * deg(*this). Use FiniteField::powMod for field elements.
+  Polynom<FieldT> pow(std::size_t Pow) const {
+    Polynom<FieldT> Res(Field, {Field->one()});
+    Polynom<FieldT> Base(*this);
+    while (Pow) {
+      if (Pow & 1)
+        Res = Res.mul(Base);
+      Pow >>= 1;
+      if (Pow)
+        Base = Base.mul(Base);
+    }
     return Res;
   }
 
@@ -284,20 +376,21 @@ public:
       return;
     }
     bool NeedPlus = false;
-    for (auto It = Monoms.begin(); It != Monoms.end(); ++It) {
-      if (It->Coeff != Field->zero()) {
+    for (std::size_t Deg = 0; Deg < Coeffs.size(); Deg++) {
+      const auto &Coeff = Coeffs[Deg];
+      if (Coeff != Field->zero()) {
         if (NeedPlus)
           OS << " + ";
         NeedPlus = false;
-        if (It->Coeff != Field->one() || It->Degree == 0) {
-          OS << It->Coeff;
+        if (Coeff != Field->one() || Deg == 0) {
+          OS << Coeff;
           NeedPlus = true;
         }
-        if (It->Degree != 0) {
+        if (Deg != 0) {
           OS << Letter;
           NeedPlus = true;
-          if (It->Degree != 1)
-            OS << "^" << It->Degree;
+          if (Deg != 1)
+            OS << "^" << Deg;
         }
       }
     }
@@ -310,4 +403,68 @@ public:
     OS << "\n";
   }
 };
+
+// Product of two polynoms. Unlike the coefficient-wise operators it is
+// computed right away.
+template <class FieldT>
+Polynom<FieldT> operator*(const Polynom<FieldT> &Lhs,
+                          const Polynom<FieldT> &Rhs) {
+  return Lhs.mul(Rhs);
+}
+
+// Rvalue polynoms lend their storage to the result instead of a new one
+// being allocated.
+template <class FieldT, class ExprT>
+Polynom<FieldT> operator+(Polynom<FieldT> &&Lhs,
+                          const expr::PolyExpr<ExprT> &Rhs) {
+  Lhs += Rhs;
+  return std::move(Lhs);
+}
+
+template <class FieldT, class ExprT>
+Polynom<FieldT> operator+(const expr::PolyExpr<ExprT> &Lhs,
+                          Polynom<FieldT> &&Rhs) {
+  Rhs = Lhs + Rhs;
+  return std::move(Rhs);
+}
+
+template <class FieldT>
+Polynom<FieldT> operator+(Polynom<FieldT> &&Lhs, Polynom<FieldT> &&Rhs) {
+  Lhs += Rhs;
+  return std::move(Lhs);
+}
+
+template <class FieldT, class ExprT>
+Polynom<FieldT> operator-(Polynom<FieldT> &&Lhs,
+                          const expr::PolyExpr<ExprT> &Rhs) {
+  Lhs -= Rhs;
+  return std::move(Lhs);
+}
+
+template <class FieldT, class ExprT>
+Polynom<FieldT> operator-(const expr::PolyExpr<ExprT> &Lhs,
+                          Polynom<FieldT> &&Rhs) {
+  Rhs = Lhs - Rhs;
+  return std::move(Rhs);
+}
+
+template <class FieldT>
+Polynom<FieldT> operator-(Polynom<FieldT> &&Lhs, Polynom<FieldT> &&Rhs) {
+  Lhs -= Rhs;
+  return std::move(Lhs);
+}
+
+template <class FieldT>
+Polynom<FieldT> operator*(Polynom<FieldT> &&Lhs,
+                          typename Polynom<FieldT>::CoeffT MulCoeff) {
+  Lhs *= MulCoeff;
+  return std::move(Lhs);
+}
+
+template <class FieldT>
+Polynom<FieldT> operator*(typename Polynom<FieldT>::CoeffT MulCoeff,
+                          Polynom<FieldT> &&Rhs) {
+  Rhs *= MulCoeff;
+  return std::move(Rhs);
+}
 } // namespace mmath
@@ -1,24 +1,16 @@
 #pragma once
 #include <algorithm>
 #include <cassert>
-#include <cmath>
+#include <cstddef>
+#include <ModReducer.hpp>
+#include <NumberTheory.hpp>
+#include <Stats.hpp>
 #include <cstdint>
-#include <type_traits>
+#include <vector>
 
 namespace mmath {
 namespace field {
 
-template <class T, std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
-static bool IsPrime(T Val) {
-  if (Val == T(0) || Val == T(1))
-    return false;
-  T UpperBound = sqrt(Val);
-  for (T i = 2; i <= Val; ++i)
-    if (Val % i == 0)
-      return true;
-  return false;
-}
-
 class PrimeField;
 
 class PrimeFieldElement {
@@ -121,12 +113,23 @@ public:
 class PrimeField {
 private:
   std::uint64_t Order;
+  ModReducer Reducer;
+  // InverseTable[I] = I^-1 mod Order, empty unless requested.
+  std::vector<std::uint32_t> InverseTable;
+
+  void buildInverseTable();
 
 public:
   using ElementType = PrimeFieldElement;
 
-  PrimeField(std::uint64_t Order) : Order(Order) {
+  // Largest order for which an inverse table may be built (64 MiB).
+  static constexpr std::uint64_t MaxInverseTableOrder = 1 << 24;
+
+  PrimeField(std::uint64_t Order, bool UseInverseTable = false)
+      : Order(Order), Reducer(Order) {
     assert(IsPrime(Order) && "Must be prime");
+    if (UseInverseTable && Order <= MaxInverseTableOrder)
+      buildInverseTable();
   }
 
   PrimeField(const PrimeField &P) = default;
@@ -136,6 +139,19 @@ public:
 
   std::uint64_t getOrder() const { return Order; }
 
+  const ModReducer &getReducer() const { return Reducer; }
+
+  bool hasInverseTable() const { return !InverseTable.empty(); }
+
+  // Returns the multiplicative inverse of a nonzero residue.
+  std::uint64_t inverse(std::uint64_t Val) const {
+    assert(Val != 0 && Val < Order && "Must be a nonzero residue");
+    stats::count(stats::Counter::FieldInverse);
+    if (!InverseTable.empty())
+      return InverseTable[Val];
+    return Reducer.inv(Val);
+  }
+
   ElementType zero() const { return ElementType(0, this); }
 
   ElementType one() const { return ElementType(1, this); }
@@ -145,7 +161,67 @@ public:
   ElementType getValue(std::uint64_t Val) const {
     return ElementType(Val, this);
   }
+
+  // Bulk arithmetic on spans of Count canonical residues, for callers that
+  // keep raw values instead of PrimeFieldElement objects. Outputs may alias
+  // inputs. Runs AVX-512 or AVX2 kernels when the CPU has them, see
+  // BulkKernelName.
+
+  // Out = A + B, pointwise.
+  void add(std::uint64_t *Out, const std::uint64_t *A, const std::uint64_t *B,
+           std::size_t Count) const;
+  // Out = A - B, pointwise.
+  void sub(std::uint64_t *Out, const std::uint64_t *A, const std::uint64_t *B,
+           std::size_t Count) const;
+  // Out = A * B, pointwise.
+  void mul(std::uint64_t *Out, const std::uint64_t *A, const std::uint64_t *B,
+           std::size_t Count) const;
+  // Out = Scalar * A.
+  void scale(std::uint64_t *Out, std::uint64_t Scalar, const std::uint64_t *A,
+             std::size_t Count) const;
+  // Y += Scalar * X.
+  void axpy(std::uint64_t *Y, std::uint64_t Scalar, const std::uint64_t *X,
+            std::size_t Count) const;
+  // Returns the sum of A[I] * B[I].
+  std::uint64_t dot(const std::uint64_t *A, const std::uint64_t *B,
+                    std::size_t Count) const;
+  // Out = A^-1, pointwise, with zeros mapped to zero. Costs one inversion
+  // and about 3 * Count multiplications (Montgomery's trick).
+  void inverse(std::uint64_t *Out, const std::uint64_t *A,
+               std::size_t Count) const;
 };
 
+// Name of the kernel set the bulk PrimeField operations dispatch to: "avx512",
+// "avx2" or "scalar". The environment variable MMATH_BULK_KERNEL, read once at
+// startup, may name a lower level to use instead.
+const char *BulkKernelName();
+
+// Hot arithmetic is defined here rather than in the library so that polynom
+// loops can inline it.
+inline void PrimeFieldElement::setValue(std::uint64_t Value) {
+  this->Value = Field->getReducer().reduce(Value);
+}
+
+inline PrimeFieldElement &
+PrimeFieldElement::sumInPlace(const PrimeFieldElement &Other) {
+  assert(Field == Other.Field);
+  stats::count(stats::Counter::FieldAdd);
+  Value = Field->getReducer().add(Value, Other.Value);
+  return *this;
+}
+
+inline PrimeFieldElement &
+PrimeFieldElement::mulInPlace(const PrimeFieldElement &Other) {
+  assert(Field == Other.Field);
+  stats::count(stats::Counter::FieldMul);
+  Value = Field->getReducer().mul(Value, Other.Value);
+  return *this;
+}
+
+inline PrimeFieldElement &PrimeFieldElement::inverseSumInPlace() {
+  Value = Field->getReducer().neg(Value);
+  return *this;
+}
+
 } // namespace field
 } // namespace mmath
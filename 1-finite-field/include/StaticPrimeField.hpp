@@ -0,0 +1,174 @@
+#pragma once
+#include <ModReducer.hpp>
+#include <NumberTheory.hpp>
+#include <Stats.hpp>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+namespace mmath {
+namespace field {
+
+// Smallest unsigned integer type that holds every residue modulo P.
+template <std::uint64_t P>
+using StaticResidueT = std::conditional_t<
+    (P <= (std::uint64_t(1) << 8)), std::uint8_t,
+    std::conditional_t<
+        (P <= (std::uint64_t(1) << 16)), std::uint16_t,
+        std::conditional_t<(P <= (std::uint64_t(1) << 32)), std::uint32_t,
+                           std::uint64_t>>>;
+
+template <std::uint64_t P> class StaticPrimeField;
+
+// Element of F_P with the modulus known at compile time. Unlike
+// PrimeFieldElement it stores no field pointer, only the residue in the
+// smallest integer type that fits it.
+template <std::uint64_t P> class StaticPrimeFieldElement {
+private:
+  using ValueT = StaticResidueT<P>;
+  using FieldT = StaticPrimeField<P>;
+
+  ValueT Value;
+
+  // Products of two residues fit in 64 bits for P <= 2^32, where the compiler
+  // strength-reduces % by the constant. Larger moduli use 128-bit Montgomery
+  // multiplication.
+  static constexpr bool UseReducer = P > (std::uint64_t(1) << 32);
+  static constexpr ModReducer Reducer{P};
+
+public:
+  // Zero, so that arrays of elements can be value-initialized.
+  constexpr StaticPrimeFieldElement() : Value(0) {}
+
+  constexpr StaticPrimeFieldElement(std::uint64_t Value,
+                                    const FieldT * = nullptr)
+      : Value(static_cast<ValueT>(Value % P)) {}
+
+  constexpr operator std::uint64_t() const { return Value; }
+
+  constexpr StaticPrimeFieldElement &
+  sumInPlace(const StaticPrimeFieldElement &Other) {
+    stats::count(stats::Counter::FieldAdd);
+    std::uint64_t Res = std::uint64_t(Value) + Other.Value;
+    Value = static_cast<ValueT>(Res >= P ? Res - P : Res);
+    return *this;
+  }
+
+  constexpr StaticPrimeFieldElement
+  sum(const StaticPrimeFieldElement &Other) const {
+    StaticPrimeFieldElement El(*this);
+    return El.sumInPlace(Other);
+  }
+
+  constexpr StaticPrimeFieldElement
+  operator+(const StaticPrimeFieldElement &Other) const {
+    return sum(Other);
+  }
+
+  constexpr StaticPrimeFieldElement &
+  operator+=(const StaticPrimeFieldElement &Other) {
+    return sumInPlace(Other);
+  }
+
+  constexpr StaticPrimeFieldElement &
+  mulInPlace(const StaticPrimeFieldElement &Other) {
+    stats::count(stats::Counter::FieldMul);
+    if constexpr (UseReducer)
+      Value = Reducer.mul(Value, Other.Value);
+    else
+      Value = static_cast<ValueT>(std::uint64_t(Value) * Other.Value % P);
+    return *this;
+  }
+
+  constexpr StaticPrimeFieldElement
+  mul(const StaticPrimeFieldElement &Other) const {
+    StaticPrimeFieldElement El(*this);
+    return El.mulInPlace(Other);
+  }
+
+  constexpr StaticPrimeFieldElement
+  operator*(const StaticPrimeFieldElement &Other) const {
+    return mul(Other);
+  }
+
+  constexpr StaticPrimeFieldElement &
+  operator*=(const StaticPrimeFieldElement &Other) {
+    return mulInPlace(Other);
+  }
+
+  constexpr StaticPrimeFieldElement &operator++() {
+    return sumInPlace(StaticPrimeFieldElement(1));
+  }
+
+  constexpr StaticPrimeFieldElement operator++(int) {
+    StaticPrimeFieldElement Copy(*this);
+    sumInPlace(StaticPrimeFieldElement(1));
+    return Copy;
+  }
+
+  constexpr StaticPrimeFieldElement inverseSum() const {
+    StaticPrimeFieldElement E(*this);
+    return E.inverseSumInPlace();
+  }
+
+  StaticPrimeFieldElement inverseMul() const {
+    StaticPrimeFieldElement E(*this);
+    return E.inverseMulInPlace();
+  }
+
+  constexpr StaticPrimeFieldElement &inverseSumInPlace() {
+    Value = static_cast<ValueT>(Value == 0 ? 0 : P - Value);
+    return *this;
+  }
+
+  StaticPrimeFieldElement &inverseMulInPlace() {
+    stats::count(stats::Counter::FieldInverse);
+    Value = static_cast<ValueT>(Reducer.inv(Value));
+    return *this;
+  }
+
+  StaticPrimeFieldElement div(const StaticPrimeFieldElement &Other) const {
+    StaticPrimeFieldElement E(*this);
+    return E.divInPlace(Other);
+  }
+
+  StaticPrimeFieldElement &divInPlace(const StaticPrimeFieldElement &FE) {
+    return mulInPlace(FE.inverseMul());
+  }
+};
+
+// Prime field with the order fixed at compile time. Has the same interface as
+// PrimeField, so it can be used with Polynom and BasicFiniteField, but holds
+// no state: elements do not need to point back to it.
+template <std::uint64_t P> class StaticPrimeField {
+  static_assert(IsPrime(P), "P must be prime");
+
+public:
+  using ElementType = StaticPrimeFieldElement<P>;
+
+  static constexpr std::uint64_t Order = P;
+
+  constexpr StaticPrimeField([[maybe_unused]] std::uint64_t Order = P) {
+    assert(Order == P && "Order must match the template argument");
+  }
+
+  constexpr std::uint64_t getOrder() const { return P; }
+
+  constexpr ElementType zero() const { return ElementType(0); }
+
+  constexpr ElementType one() const { return ElementType(1); }
+
+  constexpr ElementType last() const { return ElementType(P - 1); }
+
+  constexpr ElementType getValue(std::uint64_t Val) const {
+    return ElementType(Val);
+  }
+
+  std::uint64_t inverse(std::uint64_t Val) const {
+    assert(Val != 0 && Val < P && "Must be a nonzero residue");
+    return ElementType(Val).inverseMul();
+  }
+};
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Operation counters and phase timers for the hot paths. They are compiled in
+// only with MMATH_FIELD_STATS defined to 1 (CMake option FINITE_FIELD_STATS);
+// otherwise count() and ScopedTimer are empty inline functions and cost
+// nothing. Each thread bumps its own counters with relaxed atomics, and read()
+// sums the live threads plus everything left behind by finished ones.
+
+#ifndef MMATH_FIELD_STATS
+#define MMATH_FIELD_STATS 0
+#endif
+
+namespace mmath {
+namespace field {
+namespace stats {
+
+enum class Counter {
+  // Prime field element additions and multiplications.
+  FieldAdd,
+  FieldMul,
+  // Prime field inversions of single elements.
+  FieldInverse,
+  // Polynom::mul calls and which kernel the long ones took.
+  PolyMul,
+  PolyMulKaratsuba,
+  PolyMulNtt,
+  // Polynom::div calls and PolyReducer reductions mod f(x).
+  PolyDiv,
+  PolyReduce,
+  // Polynom coefficient vectors allocated or copied.
+  PolyAlloc,
+  NumCounters
+};
+
+enum class Timer {
+  // FindIrredPoly: choosing f(x).
+  IrredSearch,
+  // Factorization of p^m - 1.
+  OrderFactorization,
+  // getPrimitiveElement searches.
+  PrimitiveSearch,
+  // buildLogTables.
+  LogTables,
+  NumTimers
+};
+
+constexpr std::size_t NumCounters =
+    static_cast<std::size_t>(Counter::NumCounters);
+constexpr std::size_t NumTimers = static_cast<std::size_t>(Timer::NumTimers);
+
+constexpr bool Enabled = MMATH_FIELD_STATS != 0;
+
+// Totals over all threads.
+struct Snapshot {
+  std::uint64_t Counts[NumCounters] = {};
+  std::uint64_t TimerCalls[NumTimers] = {};
+  std::uint64_t TimerNanos[NumTimers] = {};
+
+  std::uint64_t get(Counter C) const {
+    return Counts[static_cast<std::size_t>(C)];
+  }
+  double getMs(Timer T) const {
+    return TimerNanos[static_cast<std::size_t>(T)] / 1e6;
+  }
+};
+
+const char *getName(Counter C);
+const char *getName(Timer T);
+
+// Sums the counters of all threads. Counts of threads still running may be
+// a few increments behind.
+Snapshot read();
+
+// Zeroes all counters. Increments racing with the reset may survive it.
+void reset();
+
+// Writes a YAML-like report of read().
+void printReport(std::ostream &OS);
+
+namespace detail {
+// One thread's counters. Only the owning thread writes them, so relaxed
+// load-add-store suffices and never contends.
+struct ThreadBlock {
+  std::atomic<std::uint64_t> Counts[NumCounters] = {};
+  std::atomic<std::uint64_t> TimerCalls[NumTimers] = {};
+  std::atomic<std::uint64_t> TimerNanos[NumTimers] = {};
+
+  // Register with and fold into the global registry.
+  ThreadBlock();
+  ~ThreadBlock();
+};
+
+inline ThreadBlock &Local() {
+  static thread_local ThreadBlock Block;
+  return Block;
+}
+
+inline void Bump(std::atomic<std::uint64_t> &Slot, std::uint64_t N) {
+  Slot.store(Slot.load(std::memory_order_relaxed) + N,
+             std::memory_order_relaxed);
+}
+} // namespace detail
+
+#if MMATH_FIELD_STATS
+// Usable from constexpr code; compile-time evaluation counts nothing.
+constexpr void count(Counter C, std::uint64_t N = 1) {
+  if (!__builtin_is_constant_evaluated())
+    detail::Bump(detail::Local().Counts[static_cast<std::size_t>(C)], N);
+}
+
+// Adds the lifetime of the object to timer T.
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Timer T)
+      : T(T), Start(std::chrono::steady_clock::now()) {}
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+  ~ScopedTimer() {
+    auto Nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now() - Start)
+                     .count();
+    auto &Block = detail::Local();
+    auto I = static_cast<std::size_t>(T);
+    detail::Bump(Block.TimerCalls[I], 1);
+    detail::Bump(Block.TimerNanos[I], static_cast<std::uint64_t>(Nanos));
+  }
+
+private:
+  Timer T;
+  std::chrono::steady_clock::time_point Start;
+};
+#else
+constexpr void count(Counter, std::uint64_t = 1) {}
+
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Timer) {}
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+};
+#endif
+
+} // namespace stats
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,570 @@
+#include <BinaryField.hpp>
+#include <Irreducibility.hpp>
+#include <ParallelSearch.hpp>
+#include <Stats.hpp>
+#include <cassert>
+#include <cstdlib>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace mmath {
+namespace field {
+
+namespace {
+using Word = std::uint64_t;
+
+uint128_t carrylessMulPortable(Word A, Word B) {
+  // Products of A with every polynom of degree < 4, each fits in 67 bits.
+  uint128_t Table[16];
+  Table[0] = 0;
+  Table[1] = A;
+  for (int I = 2; I < 16; I += 2) {
+    Table[I] = Table[I / 2] << 1;
+    Table[I + 1] = Table[I] ^ A;
+  }
+  uint128_t Res = 0;
+  for (int Shift = 60; Shift >= 0; Shift -= 4)
+    Res = (Res << 4) ^ Table[(B >> Shift) & 0xF];
+  return Res;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("pclmul,sse2"))) uint128_t
+carrylessMulHardware(Word A, Word B) {
+  __m128i Res = _mm_clmulepi64_si128(_mm_cvtsi64_si128(A),
+                                     _mm_cvtsi64_si128(B), 0x00);
+  Word Lo = _mm_cvtsi128_si64(Res);
+  Word Hi = _mm_cvtsi128_si64(_mm_unpackhi_epi64(Res, Res));
+  return (uint128_t(Hi) << 64) | Lo;
+}
+
+const bool HardwareClmul = [] {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("pclmul") != 0;
+}();
+#else
+const bool HardwareClmul = false;
+#endif
+
+// Coefficients of P lowest degree first, one per word, as FieldCache keeps
+// them for every field.
+std::vector<std::uint64_t> CoeffWords(const BinaryPolynom &P) {
+  std::vector<std::uint64_t> Res;
+  if (auto Deg = P.getDegree())
+    for (std::size_t I = 0; I <= *Deg; I++)
+      Res.push_back(std::uint64_t(P.getCoeffAt(I)));
+  return Res;
+}
+
+int degreeOf(const Word *T, std::size_t Len) {
+  for (std::size_t I = Len; I-- > 0;)
+    if (T[I])
+      return static_cast<int>(64 * I + 63 - __builtin_clzll(T[I]));
+  return -1;
+}
+
+// Dst[0, DstLen) ^= Src[0, SrcLen) << Shift. Bits shifted past DstLen words
+// must be zero.
+void xorShifted(Word *Dst, std::size_t DstLen, const Word *Src,
+                std::size_t SrcLen, std::size_t Shift) {
+  std::size_t WordShift = Shift / 64;
+  unsigned BitShift = Shift % 64;
+  for (std::size_t I = 0; I < SrcLen && I + WordShift < DstLen; I++) {
+    Dst[I + WordShift] ^= Src[I] << BitShift;
+    if (BitShift && I + WordShift + 1 < DstLen)
+      Dst[I + WordShift + 1] ^= Src[I] >> (64 - BitShift);
+  }
+}
+} // namespace
+
+uint128_t CarrylessMul(std::uint64_t A, std::uint64_t B) {
+#if defined(__x86_64__)
+  if (HardwareClmul)
+    return carrylessMulHardware(A, B);
+#endif
+  return carrylessMulPortable(A, B);
+}
+
+bool HasHardwareCarrylessMul() { return HardwareClmul; }
+
+BinaryPolynom::BinaryPolynom(const FieldT *Field,
+                             const std::vector<CoeffT> &Coefficients)
+    : Words((Coefficients.size() + 63) / 64, 0), Field(Field) {
+  for (std::size_t I = 0; I < Coefficients.size(); I++)
+    if (Coefficients[I] != CoeffT(0))
+      Words[I / 64] |= Word(1) << (I % 64);
+  normalize();
+}
+
+void BinaryPolynom::setCoeffAt(std::size_t CoeffDeg, CoeffT Coeff) {
+  bool Bit = Coeff != CoeffT(0);
+  if (CoeffDeg / 64 >= Words.size()) {
+    if (!Bit)
+      return;
+    Words.resize(CoeffDeg / 64 + 1, 0);
+  }
+  Word Mask = Word(1) << (CoeffDeg % 64);
+  Words[CoeffDeg / 64] = Bit ? (Words[CoeffDeg / 64] | Mask)
+                             : (Words[CoeffDeg / 64] & ~Mask);
+  normalize();
+}
+
+BinaryPolynom &BinaryPolynom::sumInPlace(const BinaryPolynom &Other) {
+  if (Words.size() < Other.Words.size())
+    Words.resize(Other.Words.size(), 0);
+  for (std::size_t I = 0; I < Other.Words.size(); I++)
+    Words[I] ^= Other.Words[I];
+  normalize();
+  return *this;
+}
+
+BinaryPolynom BinaryPolynom::mul(const BinaryPolynom &Other) const {
+  if (isZero() || Other.isZero())
+    return BinaryPolynom(Field);
+  std::vector<Word> Res(Words.size() + Other.Words.size(), 0);
+  for (std::size_t I = 0; I < Words.size(); I++)
+    for (std::size_t J = 0; J < Other.Words.size(); J++) {
+      auto Prod = CarrylessMul(Words[I], Other.Words[J]);
+      Res[I + J] ^= static_cast<Word>(Prod);
+      Res[I + J + 1] ^= static_cast<Word>(Prod >> 64);
+    }
+  return fromWords(Field, std::move(Res));
+}
+
+BinaryPolynom &BinaryPolynom::shiftDegInPlace(std::size_t Shift) {
+  if (isZero())
+    return *this;
+  std::vector<Word> Res(Words.size() + Shift / 64 + 1, 0);
+  xorShifted(Res.data(), Res.size(), Words.data(), Words.size(), Shift);
+  Words = std::move(Res);
+  normalize();
+  return *this;
+}
+
+BinaryPolynom BinaryPolynom::div(const BinaryPolynom &Divisor,
+                                 BinaryPolynom &Remainder) const {
+  assert(Remainder.isZero() &&
+         "Remainder must be zero when passed to div function");
+  assert(Divisor.getDegree().has_value() && "Must have degree >= 0");
+
+  std::vector<Word> Res(Words);
+  auto DivDeg = static_cast<int>(*Divisor.getDegree());
+  auto ResDeg = degreeOf(Res.data(), Res.size());
+  std::vector<Word> Quotient(
+      ResDeg >= DivDeg ? (ResDeg - DivDeg) / 64 + 1 : 0, 0);
+  for (int Deg = ResDeg; Deg >= DivDeg; Deg--) {
+    if (!((Res[Deg / 64] >> (Deg % 64)) & 1))
+      continue;
+    auto Shift = static_cast<std::size_t>(Deg - DivDeg);
+    Quotient[Shift / 64] |= Word(1) << (Shift % 64);
+    xorShifted(Res.data(), Res.size(), Divisor.Words.data(),
+               Divisor.Words.size(), Shift);
+  }
+  Remainder = fromWords(Field, std::move(Res));
+  return fromWords(Field, std::move(Quotient));
+}
+
+BinaryPolynom BinaryPolynom::pow(std::size_t Pow) const {
+  BinaryPolynom Res = fromWords(Field, {1});
+  BinaryPolynom Base(*this);
+  while (Pow) {
+    if (Pow & 1)
+      Res = Res.mul(Base);
+    Pow >>= 1;
+    if (Pow)
+      Base = Base.mul(Base);
+  }
+  return Res;
+}
+
+void BinaryPolynom::print(std::ostream &OS, char Letter) const {
+  if (isZero()) {
+    OS << CoeffT(0) << "\n";
+    return;
+  }
+  bool NeedPlus = false;
+  auto Degree = *getDegree();
+  for (std::size_t Deg = 0; Deg <= Degree; Deg++) {
+    if (getCoeffAt(Deg) == CoeffT(0))
+      continue;
+    if (NeedPlus)
+      OS << " + ";
+    if (Deg == 0)
+      OS << CoeffT(1);
+    else {
+      OS << Letter;
+      if (Deg != 1)
+        OS << "^" << Deg;
+    }
+    NeedPlus = true;
+  }
+  OS << "\n";
+}
+
+BinaryFiniteField::BinaryFiniteField(std::uint64_t P, std::uint64_t M)
+    : M(M), Order(M < 64 ? Word(1) << M : 0), PField(P),
+      NumWords((M + 63) / 64), Primitive(&PField), IrredPoly(&PField) {
+  assert(P == 2 && "BinaryFiniteField only supports characteristic 2");
+  assert(M != 0 && "Extension degree must be positive");
+  FindIrredPoly(*this, M);
+  Irreducible = true;
+}
+
+bool BinaryFiniteField::isIrreducible() const {
+  if (!Irreducible)
+    Irreducible = IsIrreducible(*this);
+  return *Irreducible;
+}
+
+const BinaryFiniteField::ElementType &BinaryFiniteField::usePrimitivePoly() {
+  FindIrredPoly(*this, M, true);
+  Irreducible = true;
+  return IrredPoly;
+}
+
+void BinaryFiniteField::setIrredPoly(const ElementType &IrredPoly) {
+  assert(IrredPoly.getDegree() == M && "f(x) must have degree m");
+  this->IrredPoly = IrredPoly;
+  Primitive = ElementType(&PField);
+  Irreducible.reset();
+  IrredWords = IrredPoly.getWords();
+  IrredLowDegs.clear();
+  for (std::size_t Deg = 0; Deg < M; Deg++)
+    if (IrredPoly.getCoeffAt(Deg) != ElementType::CoeffT(0))
+      IrredLowDegs.push_back(Deg);
+  // Each fold lowers the degree by m - max(IrredLowDegs), so folding only pays
+  // off for few terms that sit in the lower half.
+  SparseIrred = IrredLowDegs.size() <= 4 &&
+                (IrredLowDegs.empty() || IrredLowDegs.back() <= M / 2);
+  IrredWide = 0;
+  if (M <= 64) {
+    IrredWide = IrredWords[0];
+    if (IrredWords.size() > 1)
+      IrredWide |= uint128_t(IrredWords[1]) << 64;
+  }
+}
+
+BinaryFiniteField::Word BinaryFiniteField::reduce128(uint128_t T) const {
+  if (SparseIrred) {
+    uint128_t Mask = (uint128_t(1) << M) - 1;
+    while (T >> M) {
+      uint128_t High = T >> M;
+      T &= Mask;
+      for (auto Deg : IrredLowDegs)
+        T ^= High << Deg;
+    }
+    return static_cast<Word>(T);
+  }
+  Word Words[2] = {static_cast<Word>(T), static_cast<Word>(T >> 64)};
+  int Top = degreeOf(Words, 2);
+  for (int Deg = Top; Deg >= static_cast<int>(M); Deg--)
+    if ((T >> Deg) & 1)
+      T ^= IrredWide << (Deg - M);
+  return static_cast<Word>(T);
+}
+
+BinaryFiniteField::Word BinaryFiniteField::mulMod64(Word A, Word B) const {
+  return reduce128(CarrylessMul(A, B));
+}
+
+BinaryFiniteField::Word
+BinaryFiniteField::powMod64(Word Base, std::uint64_t Exponent) const {
+  Word Res = reduce128(1);
+  Base = reduce128(Base);
+  while (Exponent) {
+    if (Exponent & 1)
+      Res = mulMod64(Res, Base);
+    Exponent >>= 1;
+    if (Exponent)
+      Base = mulMod64(Base, Base);
+  }
+  return Res;
+}
+
+void BinaryFiniteField::reduceWords(Word *T, std::size_t Len,
+                                    Word *Scratch) const {
+  if (!SparseIrred) {
+    for (int Deg = degreeOf(T, Len); Deg >= static_cast<int>(M); Deg--)
+      if ((T[Deg / 64] >> (Deg % 64)) & 1)
+        xorShifted(T, Len, IrredWords.data(), IrredWords.size(), Deg - M);
+    return;
+  }
+  std::size_t WordShift = M / 64;
+  unsigned BitShift = M % 64;
+  while (degreeOf(T, Len) >= static_cast<int>(M)) {
+    // Scratch = T >> m, then T = T mod x^m.
+    std::size_t HighLen = Len - WordShift;
+    for (std::size_t I = 0; I < HighLen; I++) {
+      Word Lo = T[I + WordShift] >> BitShift;
+      Word Hi = (BitShift && I + WordShift + 1 < Len)
+                    ? T[I + WordShift + 1] << (64 - BitShift)
+                    : 0;
+      Scratch[I] = Lo | Hi;
+    }
+    for (std::size_t I = WordShift + (BitShift ? 1 : 0); I < Len; I++)
+      T[I] = 0;
+    if (BitShift)
+      T[WordShift] &= (Word(1) << BitShift) - 1;
+    for (auto Deg : IrredLowDegs)
+      xorShifted(T, Len, Scratch, HighLen, Deg);
+  }
+}
+
+void BinaryFiniteField::mulModWords(const Word *A, const Word *B, Word *Out,
+                                    Word *Scratch) const {
+  Word *T = Scratch;
+  std::fill(T, T + 2 * NumWords, 0);
+  for (std::size_t I = 0; I < NumWords; I++)
+    for (std::size_t J = 0; J < NumWords; J++) {
+      auto Prod = CarrylessMul(A[I], B[J]);
+      T[I + J] ^= static_cast<Word>(Prod);
+      T[I + J + 1] ^= static_cast<Word>(Prod >> 64);
+    }
+  reduceWords(T, 2 * NumWords, Scratch + 2 * NumWords);
+  std::copy(T, T + NumWords, Out);
+}
+
+std::vector<BinaryFiniteField::Word>
+BinaryFiniteField::powModWords(std::vector<Word> Base,
+                               std::uint64_t Exponent) const {
+  std::vector<Word> Scratch(4 * NumWords);
+  std::vector<Word> Res(NumWords, 0);
+  Res[0] = 1;
+  while (Exponent) {
+    if (Exponent & 1)
+      mulModWords(Res.data(), Base.data(), Res.data(), Scratch.data());
+    Exponent >>= 1;
+    if (Exponent)
+      mulModWords(Base.data(), Base.data(), Base.data(), Scratch.data());
+  }
+  return Res;
+}
+
+std::vector<BinaryFiniteField::Word>
+BinaryFiniteField::toWords(const ElementType &Element) const {
+  std::vector<Word> T(Element.getWords());
+  if (T.size() < NumWords)
+    T.resize(NumWords, 0);
+  std::vector<Word> Scratch(T.size());
+  reduceWords(T.data(), T.size(), Scratch.data());
+  T.resize(NumWords);
+  return T;
+}
+
+BinaryFiniteField::ElementType
+BinaryFiniteField::reduce(const ElementType &Element) const {
+  return ElementType::fromWords(&PField, toWords(Element));
+}
+
+BinaryFiniteField::ElementType
+BinaryFiniteField::mulMod(const ElementType &A, const ElementType &B) const {
+  auto AWords = toWords(A);
+  auto BWords = toWords(B);
+  if (NumWords == 1)
+    return ElementType::fromWords(&PField, {mulMod64(AWords[0], BWords[0])});
+  std::vector<Word> Scratch(4 * NumWords);
+  mulModWords(AWords.data(), BWords.data(), AWords.data(), Scratch.data());
+  return ElementType::fromWords(&PField, std::move(AWords));
+}
+
+BinaryFiniteField::ElementType
+BinaryFiniteField::powMod(const ElementType &Element,
+                          std::uint64_t Exponent) const {
+  auto Base = toWords(Element);
+  if (NumWords == 1)
+    return ElementType::fromWords(&PField, {powMod64(Base[0], Exponent)});
+  return ElementType::fromWords(&PField,
+                                powModWords(std::move(Base), Exponent));
+}
+
+BinaryFiniteField::ElementType
+BinaryFiniteField::inverse(const ElementType &Element) const {
+  auto A = reduce(Element);
+  assert(!A.isZero() && "Zero has no inverse");
+  if (NumWords == 1) {
+    // Extended Euclid by shifts: U = G1 * A and V = G2 * A mod f(x) hold
+    // throughout, and each step cancels the top bit of the longer of U, V.
+    auto Deg = [](uint128_t T) {
+      auto High = static_cast<Word>(T >> 64);
+      return High ? 127 - __builtin_clzll(High)
+                  : 63 - __builtin_clzll(static_cast<Word>(T));
+    };
+    uint128_t U = A.getWords()[0], V = IrredWide, G1 = 1, G2 = 0;
+    while (U > 1 && V != 0) {
+      int Shift = Deg(U) - Deg(V);
+      if (Shift < 0) {
+        std::swap(U, V);
+        std::swap(G1, G2);
+        Shift = -Shift;
+      }
+      U ^= V << Shift;
+      G1 ^= G2 << Shift;
+    }
+    assert(U == 1 && "Element shares a factor with a reducible f(x)");
+    return ElementType::fromWords(&PField, {static_cast<Word>(G1)});
+  }
+
+  // R0 = S0 * A and R1 = S1 * A mod f(x). Subtraction is xor over F_2.
+  ElementType R0 = IrredPoly, R1 = A;
+  ElementType S0(&PField), S1 = ElementType::fromWords(&PField, {1});
+  while (!R1.isZero()) {
+    ElementType Rem(&PField);
+    auto Q = R0.div(R1, Rem);
+    R0 = std::move(R1);
+    R1 = std::move(Rem);
+    auto S = S0.sum(Q.mul(S1));
+    S0 = std::move(S1);
+    S1 = std::move(S);
+  }
+  assert(R0.isCoeff(PField.one()) &&
+         "Element shares a factor with a reducible f(x)");
+  return S0;
+}
+
+BinaryFiniteField::ElementType
+BinaryFiniteField::divide(const ElementType &A, const ElementType &B) const {
+  return mulMod(A, inverse(B));
+}
+
+const std::vector<std::uint64_t> &
+BinaryFiniteField::getMulGroupOrderFactors() {
+  requireSearchableOrder();
+  if (!HasOrderFactors) {
+    stats::ScopedTimer Timer(stats::Timer::OrderFactorization);
+    OrderFactors = Factorize(Order - 1);
+    HasOrderFactors = true;
+  }
+  return OrderFactors;
+}
+
+void BinaryFiniteField::requireSearchableOrder() const {
+  if (canSearchPrimitive())
+    return;
+  std::cerr << "GF(2^" << M
+            << "): primitive elements need 2^m to fit in 64 bits\n";
+  std::abort();
+}
+
+void BinaryFiniteField::printPower(std::uint64_t Exp, ElementType Rem,
+                                   bool Verbose) const {
+  std::cout << "P^" << Exp << " mod f(x) = ";
+  if (Verbose)
+    Rem.print(std::cout);
+  else {
+    Rem.trim();
+    Rem.printVector(std::cout, M);
+  }
+}
+
+bool BinaryFiniteField::isPrimitive64(Word Element, bool Print,
+                                      bool Verbose) {
+  if (Element == 0)
+    return false;
+  for (auto Q : getMulGroupOrderFactors()) {
+    auto Exp = (Order - 1) / Q;
+    auto Rem = powMod64(Element, Exp);
+    if (Print)
+      printPower(Exp, ElementType::fromWords(&PField, {Rem}), Verbose);
+    if (Rem == 1)
+      return false;
+  }
+  // Implied for an irreducible f(x); see BasicFiniteField::isPrimitive.
+  if (!Print && isIrreducible())
+    return true;
+  auto Rem = powMod64(Element, Order - 1);
+  if (Print)
+    printPower(Order - 1, ElementType::fromWords(&PField, {Rem}), Verbose);
+  return Rem == 1;
+}
+
+bool BinaryFiniteField::isPrimitive(const ElementType &Element, bool Print,
+                                    bool Verbose) {
+  requireSearchableOrder();
+  return isPrimitive64(toWords(Element)[0], Print, Verbose);
+}
+
+bool BinaryFiniteField::loadFrom(const FieldCache &Cache) {
+  auto Entry = Cache.load(2, M, CoeffWords(IrredPoly));
+  if (!Entry || Entry->Primitive.empty())
+    return false;
+  Primitive = detail::MakePoly(*this, Entry->Primitive);
+  OrderFactors = std::move(Entry->OrderFactors);
+  HasOrderFactors = true;
+  return true;
+}
+
+bool BinaryFiniteField::saveTo(const FieldCache &Cache) {
+  if (!canSearchPrimitive())
+    return false;
+  if (Primitive.isZero())
+    calculatePrimitiveElement(false, false, false);
+  if (Primitive.isZero())
+    return false;
+  CachedField Entry;
+  Entry.P = 2;
+  Entry.M = M;
+  Entry.IrredPoly = CoeffWords(IrredPoly);
+  Entry.Primitive = CoeffWords(Primitive);
+  Entry.OrderFactors = getMulGroupOrderFactors();
+  return Cache.store(Entry);
+}
+
+bool BinaryFiniteField::isPrimitiveExhaustive(const ElementType &Element,
+                                              bool Print, bool Verbose) const {
+  assert(Order != 0 && "2^m must fit in 64 bits");
+  Word Base = toWords(Element)[0];
+  Word Rem = reduce128(1);
+  std::uint64_t I;
+  for (I = 0; I < Order; I++) {
+    if (I != 0)
+      Rem = mulMod64(Rem, Base);
+    if (Print)
+      printPower(I, ElementType::fromWords(&PField, {Rem}), Verbose);
+    if (I != 0 && Rem == 1)
+      break;
+  }
+  return I == Order - 1;
+}
+
+void BinaryFiniteField::calculatePrimitiveElement(bool Print, bool Verbose,
+                                                  bool AllDegs) {
+  assert(Order != 0 && "2^m must fit in 64 bits");
+  // Candidates in the same order as BasicFiniteField::ElementGenerator, which
+  // counts with coefficients as little-endian digits.
+  bool FoundPrim = false;
+  for (Word Candidate = 0; Candidate < Order && !FoundPrim; Candidate++) {
+    if (AllDegs)
+      FoundPrim = isPrimitiveExhaustive(
+          ElementType::fromWords(&PField, {Candidate}), Print, Verbose);
+    else
+      FoundPrim = isPrimitive64(Candidate, Print, Verbose);
+    if (FoundPrim) {
+      Primitive = ElementType::fromWords(&PField, {Candidate});
+      if (Print)
+        std::cout << "P is primitive!\n";
+    }
+    if (Print)
+      std::cout << "\n";
+  }
+}
+
+void BinaryFiniteField::calculatePrimitiveElementParallel(bool AllDegs,
+                                                          unsigned NumThreads) {
+  assert(Order != 0 && "2^m must fit in 64 bits");
+  // Fill the caches up front so workers only read them.
+  getMulGroupOrderFactors();
+  isIrreducible();
+  auto Index = FindFirstParallel(Order, NumThreads, [&](Word Candidate) {
+    if (AllDegs)
+      return isPrimitiveExhaustive(
+          ElementType::fromWords(&PField, {Candidate}), false, false);
+    return isPrimitive64(Candidate, false, false);
+  });
+  if (Index != Order)
+    Primitive = ElementType::fromWords(&PField, {Index});
+}
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,423 @@
+#include <ErasureCode.hpp>
+#include <ParallelSearch.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// The inner loop computes Out = sum_j C_j In_j byte-wise. Multiplication by
+// a fixed C is linear over F_2, so C * X = C * (X & 15) + C * (X & 240) and
+// both halves come from 16-entry tables, which PSHUFB looks up for 16 bytes
+// per 128-bit lane at once.
+
+namespace mmath {
+namespace field {
+
+namespace {
+// Bytes of every shard processed together, so that a slice of each input
+// stays in cache while all output rows are computed from it.
+constexpr std::size_t ChunkBytes = 16 << 10;
+
+// Lo[X] = C * X and Hi[X] = C * (X << 4) for X < 16, per coefficient.
+constexpr std::size_t TableBytes = 32;
+
+std::vector<std::uint8_t> BuildTables(const Gf256 &F,
+                                      const std::vector<std::uint8_t> &Coeffs) {
+  std::vector<std::uint8_t> Tables(TableBytes * Coeffs.size());
+  for (std::size_t I = 0; I < Coeffs.size(); I++)
+    for (std::uint8_t X = 0; X < 16; X++) {
+      Tables[TableBytes * I + X] = F.mul(Coeffs[I], X);
+      Tables[TableBytes * I + 16 + X] = F.mul(Coeffs[I], X << 4);
+    }
+  return Tables;
+}
+
+// Arguments of one output row over the byte range [Begin, End).
+struct DotArgs {
+  const std::uint8_t *Tables;
+  const std::uint8_t *const *In;
+  std::size_t NumIn;
+  std::uint8_t *Out;
+  std::size_t Begin;
+  std::size_t End;
+};
+
+void dotScalar(const DotArgs &Args, std::size_t Begin) {
+  for (std::size_t I = Begin; I < Args.End; I++) {
+    std::uint8_t Acc = 0;
+    for (std::size_t J = 0; J < Args.NumIn; J++) {
+      const auto *T = Args.Tables + TableBytes * J;
+      auto X = Args.In[J][I];
+      Acc ^= T[X & 15] ^ T[16 + (X >> 4)];
+    }
+    Args.Out[I] = Acc;
+  }
+}
+
+enum class SimdLevel { Scalar, Ssse3, Avx2, Avx512 };
+
+// MMATH_GF256_KERNEL=scalar|ssse3|avx2|avx512 lowers the kernel level, as
+// MMATH_BULK_KERNEL does for the PrimeField kernels.
+SimdLevel CapByEnvironment(SimdLevel Supported) {
+  const char *Name = std::getenv("MMATH_GF256_KERNEL");
+  if (!Name)
+    return Supported;
+  auto Requested = Supported;
+  if (!std::strcmp(Name, "scalar"))
+    Requested = SimdLevel::Scalar;
+  else if (!std::strcmp(Name, "ssse3"))
+    Requested = SimdLevel::Ssse3;
+  else if (!std::strcmp(Name, "avx2"))
+    Requested = SimdLevel::Avx2;
+  else if (!std::strcmp(Name, "avx512"))
+    Requested = SimdLevel::Avx512;
+  return std::min(Supported, Requested);
+}
+
+#if defined(__x86_64__)
+const SimdLevel DetectedSimd = CapByEnvironment([] {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512bw"))
+    return SimdLevel::Avx512;
+  if (__builtin_cpu_supports("avx2"))
+    return SimdLevel::Avx2;
+  if (__builtin_cpu_supports("ssse3"))
+    return SimdLevel::Ssse3;
+  return SimdLevel::Scalar;
+}());
+
+// Each kernel handles a prefix of the range, two vectors per step, and
+// returns where the scalar tail starts.
+
+__attribute__((target("ssse3"))) std::size_t dotSsse3(const DotArgs &Args) {
+  auto Mask = _mm_set1_epi8(0x0f);
+  auto I = Args.Begin;
+  for (; I + 32 <= Args.End; I += 32) {
+    auto Acc0 = _mm_setzero_si128(), Acc1 = _mm_setzero_si128();
+    for (std::size_t J = 0; J < Args.NumIn; J++) {
+      const auto *T = Args.Tables + TableBytes * J;
+      auto Lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(T));
+      auto Hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(T + 16));
+      const auto *In = reinterpret_cast<const __m128i *>(Args.In[J] + I);
+      auto X0 = _mm_loadu_si128(In), X1 = _mm_loadu_si128(In + 1);
+      Acc0 = _mm_xor_si128(
+          Acc0, _mm_xor_si128(
+                    _mm_shuffle_epi8(Lo, _mm_and_si128(X0, Mask)),
+                    _mm_shuffle_epi8(
+                        Hi, _mm_and_si128(_mm_srli_epi64(X0, 4), Mask))));
+      Acc1 = _mm_xor_si128(
+          Acc1, _mm_xor_si128(
+                    _mm_shuffle_epi8(Lo, _mm_and_si128(X1, Mask)),
+                    _mm_shuffle_epi8(
+                        Hi, _mm_and_si128(_mm_srli_epi64(X1, 4), Mask))));
+    }
+    auto *Out = reinterpret_cast<__m128i *>(Args.Out + I);
+    _mm_storeu_si128(Out, Acc0);
+    _mm_storeu_si128(Out + 1, Acc1);
+  }
+  return I;
+}
+
+// VPSHUFB shuffles within 128-bit lanes, so the tables are broadcast to
+// every lane.
+__attribute__((target("avx2"))) std::size_t dotAvx2(const DotArgs &Args) {
+  auto Mask = _mm256_set1_epi8(0x0f);
+  auto I = Args.Begin;
+  for (; I + 64 <= Args.End; I += 64) {
+    auto Acc0 = _mm256_setzero_si256(), Acc1 = _mm256_setzero_si256();
+    for (std::size_t J = 0; J < Args.NumIn; J++) {
+      const auto *T = Args.Tables + TableBytes * J;
+      auto Lo = _mm256_broadcastsi128_si256(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(T)));
+      auto Hi = _mm256_broadcastsi128_si256(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(T + 16)));
+      const auto *In = reinterpret_cast<const __m256i *>(Args.In[J] + I);
+      auto X0 = _mm256_loadu_si256(In), X1 = _mm256_loadu_si256(In + 1);
+      auto H0 = _mm256_and_si256(_mm256_srli_epi64(X0, 4), Mask);
+      auto H1 = _mm256_and_si256(_mm256_srli_epi64(X1, 4), Mask);
+      Acc0 = _mm256_xor_si256(
+          Acc0,
+          _mm256_xor_si256(_mm256_shuffle_epi8(Lo, _mm256_and_si256(X0, Mask)),
+                           _mm256_shuffle_epi8(Hi, H0)));
+      Acc1 = _mm256_xor_si256(
+          Acc1,
+          _mm256_xor_si256(_mm256_shuffle_epi8(Lo, _mm256_and_si256(X1, Mask)),
+                           _mm256_shuffle_epi8(Hi, H1)));
+    }
+    auto *Out = reinterpret_cast<__m256i *>(Args.Out + I);
+    _mm256_storeu_si256(Out, Acc0);
+    _mm256_storeu_si256(Out + 1, Acc1);
+  }
+  return I;
+}
+
+__attribute__((target("avx512f,avx512bw"))) std::size_t
+dotAvx512(const DotArgs &Args) {
+  auto Mask = _mm512_set1_epi8(0x0f);
+  auto I = Args.Begin;
+  for (; I + 128 <= Args.End; I += 128) {
+    auto Acc0 = _mm512_setzero_si512(), Acc1 = _mm512_setzero_si512();
+    for (std::size_t J = 0; J < Args.NumIn; J++) {
+      const auto *T = Args.Tables + TableBytes * J;
+      auto Lo = _mm512_broadcast_i32x4(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(T)));
+      auto Hi = _mm512_broadcast_i32x4(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(T + 16)));
+      const auto *In = Args.In[J] + I;
+      auto X0 = _mm512_loadu_si512(In), X1 = _mm512_loadu_si512(In + 64);
+      auto H0 = _mm512_and_si512(_mm512_srli_epi64(X0, 4), Mask);
+      auto H1 = _mm512_and_si512(_mm512_srli_epi64(X1, 4), Mask);
+      // 0x96 is the truth table of A ^ B ^ C.
+      Acc0 = _mm512_ternarylogic_epi64(
+          Acc0, _mm512_shuffle_epi8(Lo, _mm512_and_si512(X0, Mask)),
+          _mm512_shuffle_epi8(Hi, H0), 0x96);
+      Acc1 = _mm512_ternarylogic_epi64(
+          Acc1, _mm512_shuffle_epi8(Lo, _mm512_and_si512(X1, Mask)),
+          _mm512_shuffle_epi8(Hi, H1), 0x96);
+    }
+    _mm512_storeu_si512(Args.Out + I, Acc0);
+    _mm512_storeu_si512(Args.Out + I + 64, Acc1);
+  }
+  return I;
+}
+#else
+const SimdLevel DetectedSimd = CapByEnvironment(SimdLevel::Scalar);
+#endif
+
+void dotRow(const DotArgs &Args) {
+  auto Tail = Args.Begin;
+#if defined(__x86_64__)
+  switch (DetectedSimd) {
+  case SimdLevel::Avx512:
+    Tail = dotAvx512(Args);
+    break;
+  case SimdLevel::Avx2:
+    Tail = dotAvx2(Args);
+    break;
+  case SimdLevel::Ssse3:
+    Tail = dotSsse3(Args);
+    break;
+  case SimdLevel::Scalar:
+    break;
+  }
+#endif
+  dotScalar(Args, Tail);
+}
+
+// Out[R] = sum_j Coeffs[R][j] In[j] for the Rows x Cols matrix whose nibble
+// tables are Tables, over Len bytes of every buffer.
+void MulMatrix(const std::vector<std::uint8_t> &Tables, std::size_t Rows,
+               std::size_t Cols, const std::uint8_t *const *In,
+               std::uint8_t *const *Out, std::size_t Len,
+               unsigned NumThreads) {
+  auto Work = [&](std::size_t Begin, std::size_t End) {
+    for (auto ChunkBegin = Begin; ChunkBegin < End; ChunkBegin += ChunkBytes) {
+      auto ChunkEnd = std::min(End, ChunkBegin + ChunkBytes);
+      for (std::size_t R = 0; R < Rows; R++)
+        dotRow({Tables.data() + TableBytes * Cols * R, In, Cols, Out[R],
+                ChunkBegin, ChunkEnd});
+    }
+  };
+  if (Len < ReedSolomon::MinParallelBytes || NumThreads <= 1) {
+    Work(0, Len);
+    return;
+  }
+  // Split on cache-line boundaries.
+  ParallelFor((Len + 63) / 64, NumThreads,
+              [&](std::size_t Begin, std::size_t End) {
+                Work(64 * Begin, std::min(64 * End, Len));
+              });
+}
+} // namespace
+
+const char *ErasureKernelName() {
+  switch (DetectedSimd) {
+  case SimdLevel::Avx512:
+    return "avx512";
+  case SimdLevel::Avx2:
+    return "avx2";
+  case SimdLevel::Ssse3:
+    return "ssse3";
+  default:
+    return "scalar";
+  }
+}
+
+Gf256::Gf256() {
+  BinaryFiniteField Field(2, 8);
+  buildTables(Field);
+}
+
+Gf256::Gf256(BinaryFiniteField &Field) { buildTables(Field); }
+
+void Gf256::buildTables(BinaryFiniteField &Field) {
+  const auto &Words = Field.getIrredPoly().getWords();
+  assert(Field.getIrredPoly().getDegree() == 8 && "Field must be GF(2^8)");
+  IrredPoly = static_cast<std::uint16_t>(Words[0]);
+  const auto &Primitive = Field.getPrimitiveElement();
+  auto Power = BinaryPolynom::fromWords(Field.getPrimeField(), {1});
+  for (std::size_t I = 0; I < 255; I++) {
+    auto Byte = static_cast<std::uint8_t>(
+        Power.isZero() ? 0 : Power.getWords()[0]);
+    Exp[I] = Exp[I + 255] = Byte;
+    Log[Byte] = static_cast<std::uint8_t>(I);
+    Power = Field.mulMod(Power, Primitive);
+  }
+  Log[0] = 0;
+}
+
+std::vector<std::uint8_t> CauchyMatrix(const Gf256 &F, std::size_t Rows,
+                                       std::size_t Cols) {
+  assert(Rows + Cols <= 256 && "Cauchy points must be distinct bytes");
+  std::vector<std::uint8_t> Res(Rows * Cols);
+  for (std::size_t I = 0; I < Rows; I++)
+    for (std::size_t J = 0; J < Cols; J++)
+      Res[I * Cols + J] = F.inverse(static_cast<std::uint8_t>((Cols + I) ^ J));
+  return Res;
+}
+
+std::vector<std::uint8_t> VandermondeMatrix(const Gf256 &F, std::size_t Rows,
+                                            std::size_t Cols) {
+  assert(Rows <= 256 && "Vandermonde points must be distinct bytes");
+  std::vector<std::uint8_t> Res(Rows * Cols);
+  for (std::size_t I = 0; I < Rows; I++) {
+    std::uint8_t Power = 1;
+    for (std::size_t J = 0; J < Cols; J++) {
+      Res[I * Cols + J] = Power;
+      Power = F.mul(Power, static_cast<std::uint8_t>(I));
+    }
+  }
+  return Res;
+}
+
+bool InvertMatrix(const Gf256 &F, std::vector<std::uint8_t> &A,
+                  std::size_t N) {
+  assert(A.size() == N * N && "Matrix must be square");
+  // Augmented [A | I], reduced to [I | A^-1].
+  std::vector<std::uint8_t> Aug(2 * N * N, 0);
+  for (std::size_t I = 0; I < N; I++) {
+    std::copy(A.begin() + I * N, A.begin() + (I + 1) * N,
+              Aug.begin() + 2 * N * I);
+    Aug[2 * N * I + N + I] = 1;
+  }
+  for (std::size_t Col = 0; Col < N; Col++) {
+    std::size_t Pivot = Col;
+    while (Pivot < N && Aug[2 * N * Pivot + Col] == 0)
+      Pivot++;
+    if (Pivot == N)
+      return false;
+    auto *PivotRow = &Aug[2 * N * Pivot];
+    if (Pivot != Col)
+      std::swap_ranges(PivotRow, PivotRow + 2 * N, &Aug[2 * N * Col]);
+    PivotRow = &Aug[2 * N * Col];
+    auto Inv = F.inverse(PivotRow[Col]);
+    for (std::size_t J = 0; J < 2 * N; J++)
+      PivotRow[J] = F.mul(PivotRow[J], Inv);
+    for (std::size_t Row = 0; Row < N; Row++) {
+      auto *Cur = &Aug[2 * N * Row];
+      auto Factor = Cur[Col];
+      if (Row == Col || Factor == 0)
+        continue;
+      for (std::size_t J = 0; J < 2 * N; J++)
+        Cur[J] ^= F.mul(Factor, PivotRow[J]);
+    }
+  }
+  for (std::size_t I = 0; I < N; I++)
+    std::copy(Aug.begin() + 2 * N * I + N, Aug.begin() + 2 * N * (I + 1),
+              A.begin() + I * N);
+  return true;
+}
+
+ReedSolomon::ReedSolomon(const Gf256 &F, std::size_t DataShards,
+                         std::size_t TotalShards, CodeMatrix Kind)
+    : F(F), K(DataShards), N(TotalShards) {
+  assert(K >= 1 && K <= N && N <= 256 && "Need 1 <= k <= n <= 256");
+  if (Kind == CodeMatrix::Cauchy) {
+    Parity = CauchyMatrix(F, N - K, K);
+  } else {
+    // V Top^-1 keeps every k rows invertible and makes the top the identity.
+    auto V = VandermondeMatrix(F, N, K);
+    std::vector<std::uint8_t> Top(V.begin(), V.begin() + K * K);
+    bool Ok = InvertMatrix(F, Top, K);
+    assert(Ok && "Vandermonde square must be invertible");
+    (void)Ok;
+    Parity.assign((N - K) * K, 0);
+    for (std::size_t I = 0; I < N - K; I++)
+      for (std::size_t J = 0; J < K; J++) {
+        std::uint8_t Sum = 0;
+        for (std::size_t T = 0; T < K; T++)
+          Sum ^= F.mul(V[(K + I) * K + T], Top[T * K + J]);
+        Parity[I * K + J] = Sum;
+      }
+  }
+  ParityTables = BuildTables(F, Parity);
+}
+
+void ReedSolomon::encode(const std::uint8_t *const *Data,
+                         std::uint8_t *const *ParityShards, std::size_t Len,
+                         unsigned NumThreads) const {
+  MulMatrix(ParityTables, N - K, K, Data, ParityShards, Len, NumThreads);
+}
+
+bool ReedSolomon::reconstruct(std::uint8_t *const *Shards, const bool *Present,
+                              std::size_t Len, unsigned NumThreads) const {
+  // Decode from the first k present shards.
+  std::vector<std::size_t> Used;
+  for (std::size_t I = 0; I < N && Used.size() < K; I++)
+    if (Present[I])
+      Used.push_back(I);
+  if (Used.size() < K)
+    return false;
+
+  std::vector<std::size_t> MissingData;
+  for (std::size_t I = 0; I < K; I++)
+    if (!Present[I])
+      MissingData.push_back(I);
+  if (!MissingData.empty()) {
+    // Rows of the generator for the used shards, inverted, map them back to
+    // the data.
+    std::vector<std::uint8_t> Sub(K * K, 0);
+    for (std::size_t R = 0; R < K; R++) {
+      if (Used[R] < K)
+        Sub[R * K + Used[R]] = 1;
+      else
+        std::copy(Parity.begin() + (Used[R] - K) * K,
+                  Parity.begin() + (Used[R] - K + 1) * K,
+                  Sub.begin() + R * K);
+    }
+    bool Ok = InvertMatrix(F, Sub, K);
+    assert(Ok && "Any k shards of an MDS code are independent");
+    (void)Ok;
+    std::vector<std::uint8_t> Rows;
+    std::vector<std::uint8_t *> Out;
+    for (auto I : MissingData) {
+      Rows.insert(Rows.end(), Sub.begin() + I * K, Sub.begin() + (I + 1) * K);
+      Out.push_back(Shards[I]);
+    }
+    std::vector<const std::uint8_t *> In;
+    for (auto I : Used)
+      In.push_back(Shards[I]);
+    MulMatrix(BuildTables(F, Rows), MissingData.size(), K, In.data(),
+              Out.data(), Len, NumThreads);
+  }
+
+  // The data is complete now, so lost parity is plain encoding.
+  std::vector<std::uint8_t> Rows;
+  std::vector<std::uint8_t *> Out;
+  for (std::size_t I = K; I < N; I++)
+    if (!Present[I]) {
+      Rows.insert(Rows.end(), Parity.begin() + (I - K) * K,
+                  Parity.begin() + (I - K + 1) * K);
+      Out.push_back(Shards[I]);
+    }
+  if (!Out.empty())
+    MulMatrix(BuildTables(F, Rows), Out.size(), K, Shards, Out.data(), Len,
+              NumThreads);
+  return true;
+}
+
+} // namespace field
+} // namespace mmath
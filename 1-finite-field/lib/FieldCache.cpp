@@ -0,0 +1,200 @@
+#include <FieldCache.hpp>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// File layout, all words in host byte order:
+//   Header: the HeaderWords 64-bit words listed in HeaderField.
+//   Payload: f(x), the primitive element and the factors as 64-bit words,
+//            then, when TableOrder != 0, the exp and log tables as 32-bit
+//            words.
+// The header ends with a hash of itself and covers the payload with another
+// one, so truncated or corrupted files are detected before use.
+
+namespace mmath {
+namespace field {
+
+namespace {
+constexpr std::uint64_t Magic = 0x48434143'46464d4dULL; // "MMFFCACH"
+
+enum HeaderField {
+  HMagic,
+  HVersion,
+  HP,
+  HM,
+  HIrredCount,
+  HPrimitiveCount,
+  HFactorCount,
+  HTableOrder,
+  HPayloadHash,
+  HHeaderHash,
+  HeaderWords
+};
+
+// FNV-1a over 64-bit words, with the tail bytes folded in last.
+std::uint64_t HashBytes(const std::uint8_t *Data, std::size_t Size,
+                        std::uint64_t Hash = 0xcbf29ce484222325ULL) {
+  constexpr std::uint64_t Prime = 0x100000001b3ULL;
+  std::size_t I = 0;
+  for (; I + 8 <= Size; I += 8) {
+    std::uint64_t Word;
+    std::memcpy(&Word, Data + I, 8);
+    Hash = (Hash ^ Word) * Prime;
+  }
+  for (; I < Size; I++)
+    Hash = (Hash ^ Data[I]) * Prime;
+  return Hash;
+}
+
+std::size_t PayloadSize(const std::uint64_t *Header) {
+  auto Words = Header[HIrredCount] + Header[HPrimitiveCount] +
+               Header[HFactorCount];
+  auto Tables = Header[HTableOrder] ? 2 * Header[HTableOrder] - 1 : 0;
+  return 8 * Words + 4 * Tables;
+}
+} // namespace
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string &Path) {
+  int Fd = ::open(Path.c_str(), O_RDONLY);
+  if (Fd < 0)
+    return nullptr;
+  struct stat St;
+  if (::fstat(Fd, &St) != 0 || St.st_size == 0) {
+    ::close(Fd);
+    return nullptr;
+  }
+  auto Size = static_cast<std::size_t>(St.st_size);
+  void *Addr = ::mmap(nullptr, Size, PROT_READ, MAP_SHARED, Fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  ::close(Fd);
+  if (Addr == MAP_FAILED)
+    return nullptr;
+  return std::shared_ptr<const MappedFile>(
+      new MappedFile(static_cast<const std::uint8_t *>(Addr), Size));
+}
+
+MappedFile::~MappedFile() {
+  ::munmap(const_cast<std::uint8_t *>(Data), Size);
+}
+
+std::string
+FieldCache::pathFor(std::uint64_t P, std::uint64_t M,
+                    const std::vector<std::uint64_t> &IrredPoly) const {
+  auto Hash =
+      HashBytes(reinterpret_cast<const std::uint8_t *>(IrredPoly.data()),
+                8 * IrredPoly.size());
+  char Name[64];
+  std::snprintf(Name, sizeof(Name), "gf_%llu_%llu_%016llx.cache",
+                static_cast<unsigned long long>(P),
+                static_cast<unsigned long long>(M),
+                static_cast<unsigned long long>(Hash));
+  return (std::filesystem::path(Dir) / Name).string();
+}
+
+std::optional<CachedField>
+FieldCache::load(std::uint64_t P, std::uint64_t M,
+                 const std::vector<std::uint64_t> &IrredPoly) const {
+  auto File = MappedFile::open(pathFor(P, M, IrredPoly));
+  if (!File || File->size() < 8 * HeaderWords)
+    return std::nullopt;
+
+  std::uint64_t Header[HeaderWords];
+  std::memcpy(Header, File->data(), sizeof(Header));
+  if (Header[HMagic] != Magic || Header[HVersion] != FormatVersion ||
+      Header[HHeaderHash] != HashBytes(File->data(), 8 * HHeaderHash))
+    return std::nullopt;
+  if (Header[HP] != P || Header[HM] != M ||
+      Header[HIrredCount] != IrredPoly.size())
+    return std::nullopt;
+  const auto *Payload = File->data() + 8 * HeaderWords;
+  auto Size = PayloadSize(Header);
+  if (File->size() != 8 * HeaderWords + Size ||
+      Header[HPayloadHash] != HashBytes(Payload, Size))
+    return std::nullopt;
+
+  CachedField Entry;
+  Entry.P = P;
+  Entry.M = M;
+  auto ReadWords = [&](std::vector<std::uint64_t> &Out, std::uint64_t Count) {
+    Out.resize(Count);
+    std::memcpy(Out.data(), Payload, 8 * Count);
+    Payload += 8 * Count;
+  };
+  ReadWords(Entry.IrredPoly, Header[HIrredCount]);
+  if (Entry.IrredPoly != IrredPoly)
+    return std::nullopt;
+  ReadWords(Entry.Primitive, Header[HPrimitiveCount]);
+  ReadWords(Entry.OrderFactors, Header[HFactorCount]);
+  Entry.TableOrder = Header[HTableOrder];
+  if (Entry.TableOrder) {
+    Entry.ExpTable = reinterpret_cast<const std::uint32_t *>(Payload);
+    Entry.LogTable = Entry.ExpTable + (Entry.TableOrder - 1);
+  }
+  Entry.Mapping = std::move(File);
+  return Entry;
+}
+
+bool FieldCache::store(const CachedField &Entry) const {
+  std::error_code Err;
+  std::filesystem::create_directories(Dir, Err);
+  if (Err)
+    return false;
+
+  std::uint64_t Header[HeaderWords] = {};
+  Header[HMagic] = Magic;
+  Header[HVersion] = FormatVersion;
+  Header[HP] = Entry.P;
+  Header[HM] = Entry.M;
+  Header[HIrredCount] = Entry.IrredPoly.size();
+  Header[HPrimitiveCount] = Entry.Primitive.size();
+  Header[HFactorCount] = Entry.OrderFactors.size();
+  Header[HTableOrder] = Entry.TableOrder;
+
+  std::vector<std::uint8_t> Payload(PayloadSize(Header));
+  auto *Out = Payload.data();
+  auto Append = [&](const void *Data, std::size_t Bytes) {
+    if (Bytes)
+      std::memcpy(Out, Data, Bytes);
+    Out += Bytes;
+  };
+  Append(Entry.IrredPoly.data(), 8 * Entry.IrredPoly.size());
+  Append(Entry.Primitive.data(), 8 * Entry.Primitive.size());
+  Append(Entry.OrderFactors.data(), 8 * Entry.OrderFactors.size());
+  if (Entry.TableOrder) {
+    Append(Entry.ExpTable, 4 * (Entry.TableOrder - 1));
+    Append(Entry.LogTable, 4 * Entry.TableOrder);
+  }
+  Header[HPayloadHash] = HashBytes(Payload.data(), Payload.size());
+  Header[HHeaderHash] = HashBytes(
+      reinterpret_cast<const std::uint8_t *>(Header), 8 * HHeaderHash);
+
+  auto Path = pathFor(Entry.P, Entry.M, Entry.IrredPoly);
+  // Unique per store, so threads writing the same entry do not share it.
+  static std::atomic<std::uint64_t> StoreCount{0};
+  auto TmpPath = Path + ".tmp." + std::to_string(::getpid()) + "." +
+                 std::to_string(StoreCount.fetch_add(1));
+  {
+    std::ofstream OS(TmpPath, std::ios::binary | std::ios::trunc);
+    OS.write(reinterpret_cast<const char *>(Header), sizeof(Header));
+    OS.write(reinterpret_cast<const char *>(Payload.data()), Payload.size());
+    if (!OS.flush()) {
+      std::remove(TmpPath.c_str());
+      return false;
+    }
+  }
+  std::filesystem::rename(TmpPath, Path, Err);
+  if (Err) {
+    std::remove(TmpPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+} // namespace field
+} // namespace mmath
@@ -3,37 +3,9 @@
 
 namespace mmath {
 namespace field {
-void PrimeFieldElement::setValue(std::uint64_t Value) {
-  this->Value = (Field->getOrder() == 0) ? 0 : Value % Field->getOrder();
-}
-
-PrimeFieldElement &
-PrimeFieldElement::sumInPlace(const PrimeFieldElement &Other) {
-  assert(Field == Other.Field);
-  setValue(Value + Other.Value);
-  return *this;
-}
-
-PrimeFieldElement &
-PrimeFieldElement::mulInPlace(const PrimeFieldElement &Other) {
-  assert(Field == Other.Field);
-  setValue(Value * Other.Value);
-  return *this;
-}
-
-PrimeFieldElement &PrimeFieldElement::inverseSumInPlace() {
-  setValue(Field->getOrder() - Value);
-  return *this;
-}
-
 PrimeFieldElement &PrimeFieldElement::inverseMulInPlace() {
-  for (auto I = Field->one(); I <= Field->getOrder() - 1; ++I) {
-    if (mul(I) == Field->one()) {
-      setValue(I.Value);
-      return *this;
-    }
-  }
-  assert(false && "Must not reach here");
+  Value = Field->inverse(Value);
+  return *this;
 }
 
 PrimeFieldElement &PrimeFieldElement::divInPlace(PrimeFieldElement &FE) {
@@ -50,5 +22,15 @@ PrimeFieldElement PrimeFieldElement::operator++(int) {
   sumInPlace(Field->one());
   return Copy;
 }
+
+void PrimeField::buildInverseTable() {
+  // Uses p = (p / I) * I + p % I, so I^-1 = -(p / I) * (p % I)^-1 mod p.
+  InverseTable.assign(Order, 0);
+  if (Order > 1)
+    InverseTable[1] = 1;
+  for (std::uint64_t I = 2; I < Order; I++)
+    InverseTable[I] = static_cast<std::uint32_t>(Reducer.neg(
+        Reducer.mul(Order / I, InverseTable[Order % I])));
+}
 } // namespace field
 } // namespace mmath
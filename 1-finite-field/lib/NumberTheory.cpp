@@ -0,0 +1,125 @@
+#include <NumberTheory.hpp>
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <unordered_map>
+
+namespace mmath {
+namespace field {
+
+namespace {
+// Trial division covers every factor below this bound.
+constexpr std::uint64_t SieveLimit = 1 << 16;
+
+const std::vector<std::uint32_t> &SmallPrimes() {
+  static const std::vector<std::uint32_t> Primes = [] {
+    std::vector<bool> Composite(SieveLimit, false);
+    std::vector<std::uint32_t> Res;
+    for (std::uint64_t I = 2; I < SieveLimit; I++) {
+      if (Composite[I])
+        continue;
+      Res.push_back(static_cast<std::uint32_t>(I));
+      for (auto J = I * I; J < SieveLimit; J += I)
+        Composite[J] = true;
+    }
+    return Res;
+  }();
+  return Primes;
+}
+
+// Brent's variant of Pollard's rho with f(x) = x^2 + C. Products of
+// |x - y| are accumulated in batches so that only one gcd is taken per batch.
+// Returns a nontrivial factor of the odd composite N, or N if this C failed.
+template <class MulFnT>
+std::uint64_t PollardBrent(std::uint64_t N, std::uint64_t C, MulFnT Mul) {
+  constexpr std::uint64_t BatchSize = 128;
+  auto F = [&](std::uint64_t X) {
+    auto Sq = Mul(X, X);
+    return Sq >= N - C ? Sq - (N - C) : Sq + C;
+  };
+  std::uint64_t Y = 2, X = 2, Saved = 2, Q = 1, G = 1;
+  for (std::uint64_t R = 1; G == 1; R *= 2) {
+    X = Y;
+    for (std::uint64_t I = 0; I < R; I++)
+      Y = F(Y);
+    for (std::uint64_t K = 0; K < R && G == 1; K += BatchSize) {
+      Saved = Y;
+      for (std::uint64_t I = 0; I < std::min(BatchSize, R - K); I++) {
+        Y = F(Y);
+        Q = Mul(Q, X > Y ? X - Y : Y - X);
+      }
+      G = std::gcd(Q, N);
+    }
+  }
+  if (G == N) {
+    // The batch overshot; redo it one step at a time.
+    do {
+      Saved = F(Saved);
+      G = std::gcd(X > Saved ? X - Saved : Saved - X, N);
+    } while (G == 1);
+  }
+  return G;
+}
+
+// Appends the prime factors of N > 1, which has no factors below SieveLimit.
+void FactorizeLarge(std::uint64_t N, std::vector<std::uint64_t> &Factors) {
+  if (N < SieveLimit * SieveLimit || IsPrime(N)) {
+    Factors.push_back(N);
+    return;
+  }
+  std::uint64_t D = N;
+  for (std::uint64_t C = 1; D == N; C++) {
+    if (N < (std::uint64_t(1) << 63)) {
+      ModReducer R(N);
+      D = PollardBrent(N, C,
+                       [&R](std::uint64_t A, std::uint64_t B) {
+                         return R.mul(A, B);
+                       });
+    } else {
+      D = PollardBrent(N, C, [N](std::uint64_t A, std::uint64_t B) {
+        return detail::MulModWide(A, B, N);
+      });
+    }
+  }
+  FactorizeLarge(D, Factors);
+  FactorizeLarge(N / D, Factors);
+}
+
+std::mutex CacheMutex;
+std::unordered_map<std::uint64_t, std::vector<std::uint64_t>> Cache;
+} // namespace
+
+std::vector<std::uint64_t> Factorize(std::uint64_t N) {
+  // 0 and 1 have no prime factors, and 0 would never leave the division loop.
+  if (N < 2)
+    return {};
+  {
+    std::lock_guard<std::mutex> Lock(CacheMutex);
+    auto It = Cache.find(N);
+    if (It != Cache.end())
+      return It->second;
+  }
+
+  std::vector<std::uint64_t> Factors;
+  auto Rest = N;
+  for (auto P : SmallPrimes()) {
+    if (std::uint64_t(P) * P > Rest)
+      break;
+    if (Rest % P != 0)
+      continue;
+    Factors.push_back(P);
+    while (Rest % P == 0)
+      Rest /= P;
+  }
+  if (Rest > 1)
+    FactorizeLarge(Rest, Factors);
+  std::sort(Factors.begin(), Factors.end());
+  Factors.erase(std::unique(Factors.begin(), Factors.end()), Factors.end());
+
+  std::lock_guard<std::mutex> Lock(CacheMutex);
+  Cache.emplace(N, Factors);
+  return Factors;
+}
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,515 @@
+#include <PrimeField.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Bulk PrimeField arithmetic. Addition and subtraction vectorize for every
+// modulus. Products use 32-bit Montgomery multiplication built on the
+// 32x32->64 lane multiply, so they vectorize for odd moduli below 2^32 and
+// fall back to ModReducer otherwise.
+
+namespace mmath {
+namespace field {
+
+namespace {
+using Word = std::uint64_t;
+
+enum class BulkOp { Add, Sub, Mul, Scale, Axpy, Dot };
+
+struct BulkArgs {
+  Word *Out;
+  const Word *A;
+  const Word *B;
+  // Scale and Axpy factor, premultiplied by 2^32 mod N.
+  Word Scalar;
+  std::size_t Count;
+  Word N;
+  // Montgomery constants, valid only when HasMont is set.
+  bool HasMont;
+  // N^-1 mod 2^32.
+  Word NInv;
+  // 2^64 mod N.
+  Word R2;
+};
+
+// Batch inversion runs Montgomery's trick on rows of BatchChains vectors, so
+// that every lane of every vector is an independent product chain and the
+// multiplier latency is hidden. Forward: Prefix[K] is the product of A[K],
+// A[K - Row], A[K - 2 Row], ... down to the first row, each multiplication
+// carrying a 2^-32 factor. Zeros are replaced by 2^32 mod N, which that
+// product treats as one. Backward: starting from the plain inverses of the
+// last prefix row, Out[K] = Inv * Prefix[K - Row] * 2^-32 is the plain
+// inverse of A[K], and Inv picks up A[K] for the previous row.
+constexpr std::size_t BatchChains = 4;
+
+enum class SimdLevel { Scalar, Avx2, Avx512 };
+
+// MMATH_BULK_KERNEL=scalar|avx2|avx512 lowers the kernel level below what
+// the CPU supports, so that every path can be checked on one machine.
+// Levels the CPU lacks are never selected.
+SimdLevel CapByEnvironment(SimdLevel Supported) {
+  const char *Name = std::getenv("MMATH_BULK_KERNEL");
+  if (!Name)
+    return Supported;
+  auto Requested = Supported;
+  if (!std::strcmp(Name, "scalar"))
+    Requested = SimdLevel::Scalar;
+  else if (!std::strcmp(Name, "avx2"))
+    Requested = SimdLevel::Avx2;
+  else if (!std::strcmp(Name, "avx512"))
+    Requested = SimdLevel::Avx512;
+  return std::min(Supported, Requested);
+}
+
+#if defined(__x86_64__)
+const SimdLevel DetectedSimd = CapByEnvironment([] {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return SimdLevel::Avx512;
+  if (__builtin_cpu_supports("avx2"))
+    return SimdLevel::Avx2;
+  return SimdLevel::Scalar;
+}());
+
+// All helpers take residues in [0, N) and return residues in [0, N). Values
+// stay below 2^63, so signed 64-bit compares order them correctly.
+
+__attribute__((target("avx2"))) inline __m256i
+addModAvx2(__m256i A, __m256i B, __m256i N) {
+  auto Sum = _mm256_add_epi64(A, B);
+  auto Less = _mm256_cmpgt_epi64(N, Sum);
+  return _mm256_blendv_epi8(_mm256_sub_epi64(Sum, N), Sum, Less);
+}
+
+__attribute__((target("avx2"))) inline __m256i
+subModAvx2(__m256i A, __m256i B, __m256i N) {
+  auto Diff = _mm256_sub_epi64(A, B);
+  auto Borrow = _mm256_cmpgt_epi64(B, A);
+  return _mm256_add_epi64(Diff, _mm256_and_si256(Borrow, N));
+}
+
+// Returns A * B * 2^-32 mod N. With M = lo(A * B) * N^-1 mod 2^32 the low
+// halves of A * B and M * N agree, so the difference of the high halves is
+// exact and lies in (-N, N).
+__attribute__((target("avx2"))) inline __m256i
+montMulAvx2(__m256i A, __m256i B, __m256i N, __m256i NInv) {
+  auto T = _mm256_mul_epu32(A, B);
+  auto M = _mm256_mul_epu32(T, NInv);
+  auto MN = _mm256_mul_epu32(M, N);
+  auto U =
+      _mm256_sub_epi64(_mm256_srli_epi64(T, 32), _mm256_srli_epi64(MN, 32));
+  auto Neg = _mm256_cmpgt_epi64(_mm256_setzero_si256(), U);
+  return _mm256_add_epi64(U, _mm256_and_si256(Neg, N));
+}
+
+// Processes a prefix of the spans and returns its length. For Dot, adds the
+// sum of A * B * 2^-32 over the prefix to DotSum.
+__attribute__((target("avx2"))) std::size_t
+bulkAvx2(BulkOp Op, const BulkArgs &Args, Word &DotSum) {
+  if (Op != BulkOp::Add && Op != BulkOp::Sub && !Args.HasMont)
+    return 0;
+  auto *A256 = reinterpret_cast<const __m256i *>(Args.A);
+  auto *B256 = reinterpret_cast<const __m256i *>(Args.B);
+  auto *Out256 = reinterpret_cast<__m256i *>(Args.Out);
+  auto N = _mm256_set1_epi64x(Args.N);
+  auto NInv = _mm256_set1_epi64x(Args.NInv);
+  auto R2 = _mm256_set1_epi64x(Args.R2);
+  auto Scalar = _mm256_set1_epi64x(Args.Scalar);
+  auto Acc = _mm256_setzero_si256();
+  std::size_t End = Args.Count & ~std::size_t(3);
+  for (std::size_t I = 0; I < End; I += 4) {
+    auto A = _mm256_loadu_si256(A256 + I / 4);
+    auto B = Args.B ? _mm256_loadu_si256(B256 + I / 4) : A;
+    __m256i Res;
+    switch (Op) {
+    case BulkOp::Add:
+      Res = addModAvx2(A, B, N);
+      break;
+    case BulkOp::Sub:
+      Res = subModAvx2(A, B, N);
+      break;
+    case BulkOp::Mul:
+      Res = montMulAvx2(montMulAvx2(A, B, N, NInv), R2, N, NInv);
+      break;
+    case BulkOp::Scale:
+      Res = montMulAvx2(A, Scalar, N, NInv);
+      break;
+    case BulkOp::Axpy:
+      Res = addModAvx2(_mm256_loadu_si256(Out256 + I / 4),
+                       montMulAvx2(A, Scalar, N, NInv), N);
+      break;
+    case BulkOp::Dot:
+      Acc = addModAvx2(Acc, montMulAvx2(A, B, N, NInv), N);
+      continue;
+    }
+    _mm256_storeu_si256(Out256 + I / 4, Res);
+  }
+  if (Op == BulkOp::Dot) {
+    alignas(32) Word Lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(Lanes), Acc);
+    for (auto L : Lanes)
+      DotSum = DotSum + L >= Args.N ? DotSum + L - Args.N : DotSum + L;
+  }
+  return End;
+}
+
+__attribute__((target("avx2"))) void
+batchInvForwardAvx2(const BulkArgs &Args, Word *Prefix, std::size_t End) {
+  auto N = _mm256_set1_epi64x(Args.N);
+  auto NInv = _mm256_set1_epi64x(Args.NInv);
+  auto One = _mm256_set1_epi64x(Args.Scalar);
+  auto Zero = _mm256_setzero_si256();
+  __m256i Acc[BatchChains];
+  for (auto &V : Acc)
+    V = One;
+  for (std::size_t I = 0; I < End; I += 4 * BatchChains)
+    for (std::size_t C = 0; C < BatchChains; C++) {
+      auto *Src = reinterpret_cast<const __m256i *>(Args.A + I + 4 * C);
+      auto A = _mm256_loadu_si256(Src);
+      A = _mm256_blendv_epi8(A, One, _mm256_cmpeq_epi64(A, Zero));
+      Acc[C] = montMulAvx2(Acc[C], A, N, NInv);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(Prefix + I + 4 * C),
+                          Acc[C]);
+    }
+}
+
+__attribute__((target("avx2"))) void
+batchInvBackwardAvx2(const BulkArgs &Args, const Word *Prefix,
+                     std::size_t End, const Word *LastInv) {
+  constexpr std::size_t Row = 4 * BatchChains;
+  auto N = _mm256_set1_epi64x(Args.N);
+  auto NInv = _mm256_set1_epi64x(Args.NInv);
+  auto One = _mm256_set1_epi64x(Args.Scalar);
+  auto Zero = _mm256_setzero_si256();
+  __m256i Inv[BatchChains];
+  for (std::size_t C = 0; C < BatchChains; C++)
+    Inv[C] = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(LastInv + 4 * C));
+  for (std::size_t I = End; I != 0;) {
+    I -= Row;
+    for (std::size_t C = 0; C < BatchChains; C++) {
+      auto K = I + 4 * C;
+      // Out may alias A, so A is loaded before Out is stored.
+      auto A =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Args.A + K));
+      auto IsZero = _mm256_cmpeq_epi64(A, Zero);
+      auto Prev = I ? _mm256_loadu_si256(
+                          reinterpret_cast<const __m256i *>(Prefix + K - Row))
+                    : One;
+      auto Res = montMulAvx2(Inv[C], Prev, N, NInv);
+      Inv[C] = montMulAvx2(Inv[C], _mm256_blendv_epi8(A, One, IsZero), N,
+                           NInv);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(Args.Out + K),
+                          _mm256_andnot_si256(IsZero, Res));
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) inline __m512i
+addModAvx512(__m512i A, __m512i B, __m512i N) {
+  auto Sum = _mm512_add_epi64(A, B);
+  auto NotLess = _mm512_cmpge_epu64_mask(Sum, N);
+  return _mm512_mask_sub_epi64(Sum, NotLess, Sum, N);
+}
+
+__attribute__((target("avx512f"))) inline __m512i
+subModAvx512(__m512i A, __m512i B, __m512i N) {
+  auto Diff = _mm512_sub_epi64(A, B);
+  auto Borrow = _mm512_cmplt_epu64_mask(A, B);
+  return _mm512_mask_add_epi64(Diff, Borrow, Diff, N);
+}
+
+// Same as montMulAvx2.
+__attribute__((target("avx512f"))) inline __m512i
+montMulAvx512(__m512i A, __m512i B, __m512i N, __m512i NInv) {
+  auto T = _mm512_mul_epu32(A, B);
+  auto M = _mm512_mul_epu32(T, NInv);
+  auto MN = _mm512_mul_epu32(M, N);
+  auto THi = _mm512_srli_epi64(T, 32);
+  auto MNHi = _mm512_srli_epi64(MN, 32);
+  auto Borrow = _mm512_cmplt_epu64_mask(THi, MNHi);
+  auto U = _mm512_sub_epi64(THi, MNHi);
+  return _mm512_mask_add_epi64(U, Borrow, U, N);
+}
+
+// Same as bulkAvx2 with eight lanes.
+__attribute__((target("avx512f"))) std::size_t
+bulkAvx512(BulkOp Op, const BulkArgs &Args, Word &DotSum) {
+  if (Op != BulkOp::Add && Op != BulkOp::Sub && !Args.HasMont)
+    return 0;
+  auto N = _mm512_set1_epi64(Args.N);
+  auto NInv = _mm512_set1_epi64(Args.NInv);
+  auto R2 = _mm512_set1_epi64(Args.R2);
+  auto Scalar = _mm512_set1_epi64(Args.Scalar);
+  auto Acc = _mm512_setzero_si512();
+  std::size_t End = Args.Count & ~std::size_t(7);
+  for (std::size_t I = 0; I < End; I += 8) {
+    auto A = _mm512_loadu_si512(Args.A + I);
+    auto B = Args.B ? _mm512_loadu_si512(Args.B + I) : A;
+    __m512i Res;
+    switch (Op) {
+    case BulkOp::Add:
+      Res = addModAvx512(A, B, N);
+      break;
+    case BulkOp::Sub:
+      Res = subModAvx512(A, B, N);
+      break;
+    case BulkOp::Mul:
+      Res = montMulAvx512(montMulAvx512(A, B, N, NInv), R2, N, NInv);
+      break;
+    case BulkOp::Scale:
+      Res = montMulAvx512(A, Scalar, N, NInv);
+      break;
+    case BulkOp::Axpy:
+      Res = addModAvx512(_mm512_loadu_si512(Args.Out + I),
+                         montMulAvx512(A, Scalar, N, NInv), N);
+      break;
+    case BulkOp::Dot:
+      Acc = addModAvx512(Acc, montMulAvx512(A, B, N, NInv), N);
+      continue;
+    }
+    _mm512_storeu_si512(Args.Out + I, Res);
+  }
+  if (Op == BulkOp::Dot) {
+    alignas(64) Word Lanes[8];
+    _mm512_store_si512(Lanes, Acc);
+    for (auto L : Lanes)
+      DotSum = DotSum + L >= Args.N ? DotSum + L - Args.N : DotSum + L;
+  }
+  return End;
+}
+// Same as batchInvForwardAvx2 with eight lanes.
+__attribute__((target("avx512f"))) void
+batchInvForwardAvx512(const BulkArgs &Args, Word *Prefix, std::size_t End) {
+  auto N = _mm512_set1_epi64(Args.N);
+  auto NInv = _mm512_set1_epi64(Args.NInv);
+  auto One = _mm512_set1_epi64(Args.Scalar);
+  auto Zero = _mm512_setzero_si512();
+  __m512i Acc[BatchChains];
+  for (auto &V : Acc)
+    V = One;
+  for (std::size_t I = 0; I < End; I += 8 * BatchChains)
+    for (std::size_t C = 0; C < BatchChains; C++) {
+      auto A = _mm512_loadu_si512(Args.A + I + 8 * C);
+      A = _mm512_mask_blend_epi64(_mm512_cmpeq_epi64_mask(A, Zero), A, One);
+      Acc[C] = montMulAvx512(Acc[C], A, N, NInv);
+      _mm512_storeu_si512(Prefix + I + 8 * C, Acc[C]);
+    }
+}
+
+// Same as batchInvBackwardAvx2 with eight lanes.
+__attribute__((target("avx512f"))) void
+batchInvBackwardAvx512(const BulkArgs &Args, const Word *Prefix,
+                       std::size_t End, const Word *LastInv) {
+  constexpr std::size_t Row = 8 * BatchChains;
+  auto N = _mm512_set1_epi64(Args.N);
+  auto NInv = _mm512_set1_epi64(Args.NInv);
+  auto One = _mm512_set1_epi64(Args.Scalar);
+  auto Zero = _mm512_setzero_si512();
+  __m512i Inv[BatchChains];
+  for (std::size_t C = 0; C < BatchChains; C++)
+    Inv[C] = _mm512_loadu_si512(LastInv + 8 * C);
+  for (std::size_t I = End; I != 0;) {
+    I -= Row;
+    for (std::size_t C = 0; C < BatchChains; C++) {
+      auto K = I + 8 * C;
+      auto A = _mm512_loadu_si512(Args.A + K);
+      auto IsZero = _mm512_cmpeq_epi64_mask(A, Zero);
+      auto Prev = I ? _mm512_loadu_si512(Prefix + K - Row) : One;
+      auto Res = montMulAvx512(Inv[C], Prev, N, NInv);
+      Inv[C] = montMulAvx512(Inv[C], _mm512_mask_blend_epi64(IsZero, A, One),
+                             N, NInv);
+      _mm512_storeu_si512(Args.Out + K, _mm512_maskz_mov_epi64(~IsZero, Res));
+    }
+  }
+}
+#else
+const SimdLevel DetectedSimd = CapByEnvironment(SimdLevel::Scalar);
+#endif
+
+// Runs the vector kernel on a prefix and returns where the scalar tail
+// starts.
+std::size_t runVector(BulkOp Op, const BulkArgs &Args, Word &DotSum) {
+  // The kernels compare sums of two residues as signed 64-bit values.
+  if (Args.N >> 62)
+    return 0;
+#if defined(__x86_64__)
+  if (DetectedSimd == SimdLevel::Avx512)
+    return bulkAvx512(Op, Args, DotSum);
+  if (DetectedSimd == SimdLevel::Avx2)
+    return bulkAvx2(Op, Args, DotSum);
+#endif
+  return 0;
+}
+
+BulkArgs MakeArgs(const ModReducer &R, Word *Out, const Word *A,
+                  const Word *B, std::size_t Count) {
+  BulkArgs Args{Out, A, B, 0, Count, R.getModulus(), false, 0, 0};
+  auto N = Args.N;
+  if (N % 2 == 1 && N < (Word(1) << 32)) {
+    Args.HasMont = true;
+    // Each Newton step doubles the number of correct low bits; N * N == 1
+    // mod 8 gives the first three.
+    Word Inv = N;
+    for (int I = 0; I < 4; I++)
+      Inv *= 2 - N * Inv;
+    Args.NInv = Inv & 0xFFFFFFFF;
+    Args.R2 = R.mul(R.reduce(Word(1) << 32), R.reduce(Word(1) << 32));
+  }
+  return Args;
+}
+
+// 2^32 mod N, which turns X into its Montgomery form X * 2^32.
+Word montFactor(const ModReducer &R) { return R.reduce(Word(1) << 32); }
+
+// Lanes per batch inversion row of the detected kernel, or 0 when the
+// modulus has no vector path.
+std::size_t batchInvRow(const BulkArgs &Args) {
+  if (!Args.HasMont)
+    return 0;
+#if defined(__x86_64__)
+  if (DetectedSimd == SimdLevel::Avx512)
+    return 8 * BatchChains;
+  if (DetectedSimd == SimdLevel::Avx2)
+    return 4 * BatchChains;
+#endif
+  return 0;
+}
+
+// Montgomery's trick with ModReducer. Prefix must not alias A.
+void batchInvScalar(const ModReducer &R, Word *Out, const Word *A,
+                    std::size_t Count, Word *Prefix) {
+  if (Count == 0)
+    return;
+  Word Acc = 1;
+  for (std::size_t I = 0; I < Count; I++) {
+    if (A[I] != 0)
+      Acc = R.mul(Acc, A[I]);
+    Prefix[I] = Acc;
+  }
+  auto Inv = R.inv(Acc);
+  for (std::size_t I = Count; I-- > 0;) {
+    auto V = A[I];
+    if (V == 0) {
+      Out[I] = 0;
+      continue;
+    }
+    Out[I] = I ? R.mul(Inv, Prefix[I - 1]) : Inv;
+    Inv = R.mul(Inv, V);
+  }
+}
+} // namespace
+
+const char *BulkKernelName() {
+  switch (DetectedSimd) {
+  case SimdLevel::Avx512:
+    return "avx512";
+  case SimdLevel::Avx2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+void PrimeField::add(std::uint64_t *Out, const std::uint64_t *A,
+                     const std::uint64_t *B, std::size_t Count) const {
+  Word Unused = 0;
+  auto I = runVector(BulkOp::Add, MakeArgs(Reducer, Out, A, B, Count), Unused);
+  for (; I < Count; I++)
+    Out[I] = Reducer.add(A[I], B[I]);
+}
+
+void PrimeField::sub(std::uint64_t *Out, const std::uint64_t *A,
+                     const std::uint64_t *B, std::size_t Count) const {
+  Word Unused = 0;
+  auto I = runVector(BulkOp::Sub, MakeArgs(Reducer, Out, A, B, Count), Unused);
+  for (; I < Count; I++)
+    Out[I] = Reducer.sub(A[I], B[I]);
+}
+
+void PrimeField::mul(std::uint64_t *Out, const std::uint64_t *A,
+                     const std::uint64_t *B, std::size_t Count) const {
+  Word Unused = 0;
+  auto I = runVector(BulkOp::Mul, MakeArgs(Reducer, Out, A, B, Count), Unused);
+  for (; I < Count; I++)
+    Out[I] = Reducer.mul(A[I], B[I]);
+}
+
+void PrimeField::scale(std::uint64_t *Out, std::uint64_t Scalar,
+                       const std::uint64_t *A, std::size_t Count) const {
+  auto Args = MakeArgs(Reducer, Out, A, nullptr, Count);
+  Args.Scalar = Reducer.mul(Scalar, montFactor(Reducer));
+  Word Unused = 0;
+  auto I = runVector(BulkOp::Scale, Args, Unused);
+  for (; I < Count; I++)
+    Out[I] = Reducer.mul(A[I], Scalar);
+}
+
+void PrimeField::axpy(std::uint64_t *Y, std::uint64_t Scalar,
+                      const std::uint64_t *X, std::size_t Count) const {
+  auto Args = MakeArgs(Reducer, Y, X, nullptr, Count);
+  Args.Scalar = Reducer.mul(Scalar, montFactor(Reducer));
+  Word Unused = 0;
+  auto I = runVector(BulkOp::Axpy, Args, Unused);
+  for (; I < Count; I++)
+    Y[I] = Reducer.add(Y[I], Reducer.mul(X[I], Scalar));
+}
+
+std::uint64_t PrimeField::dot(const std::uint64_t *A, const std::uint64_t *B,
+                              std::size_t Count) const {
+  Word Sum = 0;
+  auto I = runVector(BulkOp::Dot, MakeArgs(Reducer, nullptr, A, B, Count), Sum);
+  // The vector part carries an extra 2^-32 factor.
+  if (I != 0)
+    Sum = Reducer.mul(Sum, montFactor(Reducer));
+  for (; I < Count; I++)
+    Sum = Reducer.add(Sum, Reducer.mul(A[I], B[I]));
+  return Sum;
+}
+
+void PrimeField::inverse(std::uint64_t *Out, const std::uint64_t *A,
+                         std::size_t Count) const {
+  // Prefix products go to Out unless they would overwrite A.
+  thread_local std::vector<Word> Scratch;
+  Word *Prefix = Out;
+  if (Out == A) {
+    Scratch.resize(Count);
+    Prefix = Scratch.data();
+  }
+  auto Args = MakeArgs(Reducer, Out, A, nullptr, Count);
+  Args.Scalar = montFactor(Reducer);
+  auto Row = batchInvRow(Args);
+  if (Row == 0 || Count < 2 * Row) {
+    batchInvScalar(Reducer, Out, A, Count, Prefix);
+    return;
+  }
+
+  auto End = Count - Count % Row;
+#if defined(__x86_64__)
+  if (DetectedSimd == SimdLevel::Avx512)
+    batchInvForwardAvx512(Args, Prefix, End);
+  else
+    batchInvForwardAvx2(Args, Prefix, End);
+#endif
+  // The last prefix row and the scalar tail share the one inversion.
+  Word Vals[2 * 8 * BatchChains], Invs[2 * 8 * BatchChains],
+      Pre[2 * 8 * BatchChains];
+  auto Tail = Count - End;
+  std::copy(Prefix + End - Row, Prefix + End, Vals);
+  std::copy(A + End, A + Count, Vals + Row);
+  batchInvScalar(Reducer, Invs, Vals, Row + Tail, Pre);
+  std::copy(Invs + Row, Invs + Row + Tail, Out + End);
+#if defined(__x86_64__)
+  if (DetectedSimd == SimdLevel::Avx512)
+    batchInvBackwardAvx512(Args, Prefix, End, Invs);
+  else
+    batchInvBackwardAvx2(Args, Prefix, End, Invs);
+#endif
+}
+
+} // namespace field
+} // namespace mmath
@@ -0,0 +1,131 @@
+#include <Stats.hpp>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace mmath {
+namespace field {
+namespace stats {
+
+namespace {
+struct Registry {
+  std::mutex Mutex;
+  std::vector<detail::ThreadBlock *> Live;
+  // Totals of threads that have exited.
+  Snapshot Retired;
+};
+
+// Never destroyed, so that thread blocks outliving main can still unregister.
+Registry &GetRegistry() {
+  static auto *R = new Registry;
+  return *R;
+}
+
+void AddBlock(Snapshot &S, const detail::ThreadBlock &B) {
+  for (std::size_t I = 0; I < NumCounters; I++)
+    S.Counts[I] += B.Counts[I].load(std::memory_order_relaxed);
+  for (std::size_t I = 0; I < NumTimers; I++) {
+    S.TimerCalls[I] += B.TimerCalls[I].load(std::memory_order_relaxed);
+    S.TimerNanos[I] += B.TimerNanos[I].load(std::memory_order_relaxed);
+  }
+}
+} // namespace
+
+detail::ThreadBlock::ThreadBlock() {
+  auto &R = GetRegistry();
+  std::lock_guard<std::mutex> Lock(R.Mutex);
+  R.Live.push_back(this);
+}
+
+detail::ThreadBlock::~ThreadBlock() {
+  auto &R = GetRegistry();
+  std::lock_guard<std::mutex> Lock(R.Mutex);
+  AddBlock(R.Retired, *this);
+  R.Live.erase(std::find(R.Live.begin(), R.Live.end(), this));
+}
+
+const char *getName(Counter C) {
+  switch (C) {
+  case Counter::FieldAdd:
+    return "field_add";
+  case Counter::FieldMul:
+    return "field_mul";
+  case Counter::FieldInverse:
+    return "field_inverse";
+  case Counter::PolyMul:
+    return "poly_mul";
+  case Counter::PolyMulKaratsuba:
+    return "poly_mul_karatsuba";
+  case Counter::PolyMulNtt:
+    return "poly_mul_ntt";
+  case Counter::PolyDiv:
+    return "poly_div";
+  case Counter::PolyReduce:
+    return "poly_reduce";
+  case Counter::PolyAlloc:
+    return "poly_alloc";
+  default:
+    return "unknown";
+  }
+}
+
+const char *getName(Timer T) {
+  switch (T) {
+  case Timer::IrredSearch:
+    return "irred_search";
+  case Timer::OrderFactorization:
+    return "order_factorization";
+  case Timer::PrimitiveSearch:
+    return "primitive_search";
+  case Timer::LogTables:
+    return "log_tables";
+  default:
+    return "unknown";
+  }
+}
+
+Snapshot read() {
+  auto &R = GetRegistry();
+  std::lock_guard<std::mutex> Lock(R.Mutex);
+  Snapshot S = R.Retired;
+  for (auto *B : R.Live)
+    AddBlock(S, *B);
+  return S;
+}
+
+void reset() {
+  auto &R = GetRegistry();
+  std::lock_guard<std::mutex> Lock(R.Mutex);
+  R.Retired = Snapshot();
+  for (auto *B : R.Live) {
+    for (auto &C : B->Counts)
+      C.store(0, std::memory_order_relaxed);
+    for (std::size_t I = 0; I < NumTimers; I++) {
+      B->TimerCalls[I].store(0, std::memory_order_relaxed);
+      B->TimerNanos[I].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void printReport(std::ostream &OS) {
+  OS << "stats:\n";
+  if (!Enabled) {
+    OS << "  enabled: false\n";
+    return;
+  }
+  auto S = read();
+  OS << "  enabled: true\n  counters:\n";
+  for (std::size_t I = 0; I < NumCounters; I++)
+    OS << "    " << getName(static_cast<Counter>(I)) << ": " << S.Counts[I]
+       << "\n";
+  OS << "  timers:\n";
+  for (std::size_t I = 0; I < NumTimers; I++) {
+    auto T = static_cast<Timer>(I);
+    OS << "    " << getName(T) << ": {calls: " << S.TimerCalls[I]
+       << ", ms: " << S.getMs(T) << "}\n";
+  }
+}
+
+} // namespace stats
+} // namespace field
+} // namespace mmath
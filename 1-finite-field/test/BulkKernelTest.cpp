@@ -0,0 +1,117 @@
+#include <ModReducer.hpp>
+#include <PrimeField.hpp>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Checks the bulk PrimeField operations against ModReducer, one residue at a
+// time. Run it with MMATH_BULK_KERNEL set to the level named by the argument;
+// it exits with 77 (skipped) when the CPU does not have that level.
+//
+// Usage: 1_finite_field_bulk_test scalar|avx2|avx512
+
+namespace {
+using namespace mmath::field;
+using Word = std::uint64_t;
+
+std::size_t Failures = 0;
+
+void Expect(bool Ok, const char *Op, Word P, std::size_t Count) {
+  if (Ok)
+    return;
+  Failures++;
+  std::cerr << Op << " mismatch for p = " << P << ", count = " << Count
+            << "\n";
+}
+
+void CheckModulus(Word P, std::mt19937_64 &Rng) {
+  PrimeField F(P);
+  ModReducer R(P);
+  for (std::size_t Count : {0, 1, 3, 4, 7, 8, 9, 31, 32, 33, 100, 1000, 4099}) {
+    std::vector<Word> A(Count), B(Count), Y(Count), Out(Count),
+        Expected(Count);
+    for (std::size_t I = 0; I < Count; I++) {
+      A[I] = Rng() % P;
+      B[I] = Rng() % P;
+      Y[I] = Rng() % P;
+    }
+    // Zeros and the largest residue are the edge cases of every kernel.
+    for (std::size_t I = 0; I < Count; I += 5) {
+      A[I] = 0;
+      B[(I + 2) % Count] = P - 1;
+      Y[(I + 3) % Count] = P - 1;
+    }
+    Word Scalar = Rng() % P;
+
+    F.add(Out.data(), A.data(), B.data(), Count);
+    for (std::size_t I = 0; I < Count; I++)
+      Expected[I] = R.add(A[I], B[I]);
+    Expect(Out == Expected, "add", P, Count);
+
+    F.sub(Out.data(), A.data(), B.data(), Count);
+    for (std::size_t I = 0; I < Count; I++)
+      Expected[I] = R.sub(A[I], B[I]);
+    Expect(Out == Expected, "sub", P, Count);
+
+    F.mul(Out.data(), A.data(), B.data(), Count);
+    for (std::size_t I = 0; I < Count; I++)
+      Expected[I] = R.mul(A[I], B[I]);
+    Expect(Out == Expected, "mul", P, Count);
+
+    Out = A;
+    F.mul(Out.data(), Out.data(), B.data(), Count);
+    Expect(Out == Expected, "mul in place", P, Count);
+
+    F.scale(Out.data(), Scalar, A.data(), Count);
+    for (std::size_t I = 0; I < Count; I++)
+      Expected[I] = R.mul(Scalar, A[I]);
+    Expect(Out == Expected, "scale", P, Count);
+
+    Out = Y;
+    F.axpy(Out.data(), Scalar, A.data(), Count);
+    for (std::size_t I = 0; I < Count; I++)
+      Expected[I] = R.add(Y[I], R.mul(Scalar, A[I]));
+    Expect(Out == Expected, "axpy", P, Count);
+
+    Word Dot = 0;
+    for (std::size_t I = 0; I < Count; I++)
+      Dot = R.add(Dot, R.mul(A[I], B[I]));
+    Expect(F.dot(A.data(), B.data(), Count) == Dot, "dot", P, Count);
+
+    for (std::size_t I = 0; I < Count; I++)
+      Expected[I] = A[I] ? R.inv(A[I]) : 0;
+    F.inverse(Out.data(), A.data(), Count);
+    Expect(Out == Expected, "inverse", P, Count);
+    Out = A;
+    F.inverse(Out.data(), Out.data(), Count);
+    Expect(Out == Expected, "inverse in place", P, Count);
+  }
+}
+} // namespace
+
+int main(int argc, char const *argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " scalar|avx2|avx512\n";
+    return 1;
+  }
+  if (std::strcmp(BulkKernelName(), argv[1]) != 0) {
+    std::cout << "Kernel " << argv[1] << " is not available, got "
+              << BulkKernelName() << "\n";
+    return 77;
+  }
+  std::mt19937_64 Rng(1);
+  // Small and even moduli, moduli with the 32-bit Montgomery path, one with
+  // only vector addition, and one at 2^62 and above, which has no vector path.
+  for (Word P : {Word(2), Word(3), Word(251), Word(65537), Word(998244353),
+                 Word(4294967291), Word(2305843009213693951),
+                 Word(4611615649683210241)})
+    CheckModulus(P, Rng);
+  if (Failures) {
+    std::cerr << Failures << " mismatches with kernel " << argv[1] << "\n";
+    return 1;
+  }
+  std::cout << "Kernel " << argv[1] << " matches ModReducer\n";
+  return 0;
+}
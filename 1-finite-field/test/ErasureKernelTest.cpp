@@ -0,0 +1,96 @@
+#include <ErasureCode.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Checks Reed-Solomon encoding against products computed with Gf256::mul,
+// and reconstruction of every lost shard, for the kernel level named by the
+// argument. Run it with MMATH_GF256_KERNEL set to that level; it exits with
+// 77 (skipped) when the CPU does not have it.
+//
+// Usage: 1_finite_field_erasure_test scalar|ssse3|avx2|avx512
+
+namespace {
+using namespace mmath::field;
+
+std::size_t Failures = 0;
+
+void Expect(bool Ok, const char *What, std::size_t K, std::size_t N,
+            std::size_t Len) {
+  if (Ok)
+    return;
+  Failures++;
+  std::cerr << What << " failed for k = " << K << ", n = " << N
+            << ", len = " << Len << "\n";
+}
+
+void CheckCode(const Gf256 &F, CodeMatrix Kind, std::size_t K, std::size_t N,
+               std::size_t Len, std::mt19937_64 &Rng) {
+  ReedSolomon RS(F, K, N, Kind);
+  std::vector<std::vector<std::uint8_t>> Shards(
+      N, std::vector<std::uint8_t>(Len));
+  std::vector<std::uint8_t *> Ptrs;
+  for (auto &S : Shards)
+    Ptrs.push_back(S.data());
+  for (std::size_t I = 0; I < K; I++)
+    for (auto &B : Shards[I])
+      B = static_cast<std::uint8_t>(Rng());
+  // Buffers above MinParallelBytes are split across threads.
+  RS.encode(Ptrs.data(), Ptrs.data() + K, Len, 2);
+
+  bool Ok = true;
+  const auto &Parity = RS.getParityMatrix();
+  for (std::size_t R = 0; Ok && R < N - K; R++)
+    for (std::size_t I = 0; Ok && I < Len; I++) {
+      std::uint8_t Sum = 0;
+      for (std::size_t J = 0; J < K; J++)
+        Sum ^= F.mul(Parity[R * K + J], Shards[J][I]);
+      Ok = Sum == Shards[K + R][I];
+    }
+  Expect(Ok, "encode", K, N, Len);
+
+  // Lose n - k shards, data ones first.
+  auto Original = Shards;
+  std::unique_ptr<bool[]> Present(new bool[N]);
+  for (std::size_t I = 0; I < N; I++) {
+    Present[I] = I >= N - K;
+    if (!Present[I])
+      std::fill(Shards[I].begin(), Shards[I].end(), 0xAB);
+  }
+  Expect(RS.reconstruct(Ptrs.data(), Present.get(), Len, 2) &&
+             Shards == Original,
+         "reconstruct", K, N, Len);
+}
+} // namespace
+
+int main(int argc, char const *argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " scalar|ssse3|avx2|avx512\n";
+    return 1;
+  }
+  if (std::strcmp(ErasureKernelName(), argv[1]) != 0) {
+    std::cout << "Kernel " << argv[1] << " is not available, got "
+              << ErasureKernelName() << "\n";
+    return 77;
+  }
+  Gf256 F;
+  std::mt19937_64 Rng(1);
+  // Lengths around the 32, 64 and 128 byte steps of the kernels, and one
+  // above ReedSolomon::MinParallelBytes.
+  for (auto Kind : {CodeMatrix::Cauchy, CodeMatrix::Vandermonde})
+    for (std::size_t Len : {0, 1, 31, 32, 33, 63, 64, 65, 127, 128, 129, 1000,
+                            70001})
+      for (auto [K, N] : {std::pair<std::size_t, std::size_t>{1, 2},
+                          {4, 6}, {10, 14}, {17, 20}})
+        CheckCode(F, Kind, K, N, Len, Rng);
+  if (Failures) {
+    std::cerr << Failures << " failures with kernel " << argv[1] << "\n";
+    return 1;
+  }
+  std::cout << "Kernel " << argv[1] << " matches Gf256::mul\n";
+  return 0;
+}
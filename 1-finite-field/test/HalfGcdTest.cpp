@@ -0,0 +1,103 @@
+#include <ModReducer.hpp>
+#include <PolyGcd.hpp>
+#include <PolyMul.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+
+// Checks XgcdResidues with a low PolyHalfGcdThreshold, so that detail::HalfGcd
+// does most of the work, against the same call with the threshold out of
+// reach, which runs Euclid's algorithm only. The gcd and both cofactors must
+// match, and S A + T B = G must hold.
+//
+// Usage: 1_finite_field_half_gcd_test
+
+namespace {
+using namespace mmath::field;
+
+std::size_t Failures = 0;
+
+void Expect(bool Ok, const char *What, std::uint64_t P, std::size_t LenA,
+            std::size_t LenB, std::size_t Threshold) {
+  if (Ok)
+    return;
+  Failures++;
+  std::cerr << What << " failed for p = " << P << ", lengths " << LenA
+            << " and " << LenB << ", threshold " << Threshold << "\n";
+}
+
+Residues Trimmed(Residues A) {
+  while (!A.empty() && A.back() == 0)
+    A.pop_back();
+  return A;
+}
+
+Residues Random(std::uint64_t P, std::size_t Len, std::mt19937_64 &Rng) {
+  Residues Res(Len);
+  for (auto &C : Res)
+    C = Rng() % P;
+  if (Len)
+    Res.back() = Res.back() ? Res.back() : 1;
+  return Res;
+}
+
+void CheckPair(const ModReducer &R, const Residues &A, const Residues &B) {
+  auto P = R.getModulus();
+  PolyHalfGcdThreshold = std::numeric_limits<std::size_t>::max();
+  Residues S, T;
+  auto G = Trimmed(XgcdResidues(R, A, B, &S, &T));
+  S = Trimmed(S);
+  T = Trimmed(T);
+  for (std::size_t Threshold : {8, 64}) {
+    PolyHalfGcdThreshold = Threshold;
+    Residues HalfS, HalfT;
+    auto HalfG = Trimmed(XgcdResidues(R, A, B, &HalfS, &HalfT));
+    HalfS = Trimmed(HalfS);
+    HalfT = Trimmed(HalfT);
+    Expect(HalfG == G, "gcd", P, A.size(), B.size(), Threshold);
+    Expect(HalfS == S && HalfT == T, "cofactors", P, A.size(), B.size(),
+           Threshold);
+    Expect(Trimmed(XgcdResidues(R, A, B)) == G, "gcd without cofactors", P,
+           A.size(), B.size(), Threshold);
+
+    auto Sum = MulResidues(R, HalfS, A);
+    auto Other = MulResidues(R, HalfT, B);
+    if (Sum.size() < Other.size())
+      Sum.resize(Other.size(), 0);
+    for (std::size_t I = 0; I < Other.size(); I++)
+      Sum[I] = R.add(Sum[I], Other[I]);
+    Expect(Trimmed(Sum) == HalfG, "Bezout identity", P, A.size(), B.size(),
+           Threshold);
+  }
+}
+
+void CheckModulus(std::uint64_t P, std::mt19937_64 &Rng) {
+  ModReducer R(P);
+  for (std::size_t LenA : {0, 1, 9, 100, 513, 1500})
+    for (std::size_t LenB : {0, 8, 99, 1000}) {
+      auto A = Random(P, LenA, Rng);
+      auto B = Random(P, LenB, Rng);
+      CheckPair(R, A, B);
+      // A common factor of degree 40 makes the gcd nontrivial.
+      if (LenA && LenB) {
+        auto C = Random(P, 41, Rng);
+        CheckPair(R, MulResidues(R, A, C), MulResidues(R, B, C));
+      }
+    }
+}
+} // namespace
+
+int main() {
+  std::mt19937_64 Rng(1);
+  for (std::uint64_t P : {2ULL, 3ULL, 251ULL, 65537ULL, 998244353ULL,
+                          4294967291ULL, 2305843009213693951ULL})
+    CheckModulus(P, Rng);
+  if (Failures) {
+    std::cerr << Failures << " failures\n";
+    return 1;
+  }
+  std::cout << "Half-GCD matches Euclid's algorithm\n";
+  return 0;
+}